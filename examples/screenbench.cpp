@@ -0,0 +1,76 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Screen.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// Measures Screen::write() on a synthetic full-screen redraw stream, as emitted by
+// editors and multiplexers: each frame is a synchronized output (DEC mode 2026) batch,
+// redrawing every line via CUP, EL and a few SGR-colored words.
+//
+// Usage: screenbench [FRAME_COUNT]
+
+namespace
+{
+    string redrawFrame(int _columns, int _lines)
+    {
+        string_view constexpr words[] = { "int", "main", "return", "value", "// comment", "{", "}" };
+
+        string frame = "\033[?2026h";
+        for (int line = 1; line <= _lines; ++line)
+        {
+            frame += "\033[" + to_string(line) + ";1H\033[K";
+            int column = 0;
+            for (size_t i = static_cast<size_t>(line); column + 12 < _columns; ++i)
+            {
+                auto const word = words[i % size(words)];
+                frame += "\033[38;5;" + to_string(i % 256) + "m";
+                frame += word;
+                frame += "\033[m ";
+                column += static_cast<int>(word.size()) + 1;
+            }
+        }
+        frame += "\033[?2026l";
+        return frame;
+    }
+}
+
+int main(int argc, char const* argv[])
+{
+    auto constexpr Columns = 132;
+    auto constexpr Lines = 50;
+    auto const frameCount = argc > 1 ? atoi(argv[1]) : 2000;
+
+    auto events = terminal::ScreenEvents{};
+    auto screen = terminal::Screen{crispy::Size{Columns, Lines}, events};
+    auto const frame = redrawFrame(Columns, Lines);
+
+    auto const start = chrono::steady_clock::now();
+    for (int i = 0; i < frameCount; ++i)
+        screen.write(frame);
+    auto const end = chrono::steady_clock::now();
+
+    auto const ms = chrono::duration_cast<chrono::milliseconds>(end - start).count();
+    auto const mb = static_cast<double>(frame.size()) * frameCount / (1024.0 * 1024.0);
+
+    cout << frameCount << " frames, " << mb << " MB: " << ms << " ms" << endl;
+
+    return EXIT_SUCCESS;
+}
@@ -235,7 +235,7 @@ void ActionHandler::operator()(FollowHyperlink)
     };
     if (terminal().screen().contains(currentMousePosition))
     {
-        if (auto hyperlink = terminal().screen().at(currentMousePositionRel).hyperlink(); hyperlink != nullptr)
+        if (auto hyperlink = terminal().screen().hyperlinkAt(currentMousePositionRel); hyperlink != nullptr)
         {
             followHyperlink(*hyperlink);
             return;
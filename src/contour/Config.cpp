@@ -907,6 +907,14 @@ TerminalProfile loadTerminalProfile(YAML::Node const& _node,
                 profile.maxHistoryLineCount = limit.as<size_t>();
         }
 
+        if (auto diskQuota = history["disk_quota"]; diskQuota)
+        {
+            if (diskQuota.as<int>() <= 0)
+                profile.historyDiskQuota = nullopt;
+            else
+                profile.historyDiskQuota = diskQuota.as<size_t>() * 1024 * 1024;
+        }
+
         softLoadValue(history, "auto_scroll_on_update", profile.autoScrollOnUpdate);
         softLoadValue(history, "scroll_multiplier", profile.historyScrollMultiplier);
     }
@@ -1022,6 +1030,8 @@ void loadConfigFromFile(Config& _config, FileSystem::path const& _fileName)
     }
 
     softLoadValue(doc, "read_buffer_size", _config.ptyReadBufferSize);
+    softLoadValue(doc, "reader_ring_size", _config.ptyReaderRingSize);
+    softLoadValue(doc, "io_threads", _config.ioThreadCount);
 
     if (auto profiles = doc["profiles"]; profiles)
     {
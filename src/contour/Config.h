@@ -74,6 +74,7 @@ struct TerminalProfile {
     terminal::VTType terminalId = terminal::VTType::VT525;
 
     std::optional<int> maxHistoryLineCount;
+    std::optional<size_t> historyDiskQuota;
     int historyScrollMultiplier;
     bool autoScrollOnUpdate;
 
@@ -108,10 +109,18 @@ struct Config {
 
     std::optional<FileSystem::path> logFilePath;
 
-    // Configures the size of the PTY read buffer.
+    // Configures the size of the PTY read buffer, which temporarily grows while flooded with output.
     // Changing this value may result in better or worse throughput performance.
     int ptyReadBufferSize = 16384;
 
+    // Configures the size of the ring buffer a dedicated thread reads the PTY into,
+    // or 0 to read the PTY from the terminal's main loop directly.
+    size_t ptyReaderRingSize = 0;
+
+    // Configures the number of threads processing the PTY input of all terminal sessions,
+    // or 0 to have each terminal session process its PTY input on a thread of its own.
+    size_t ioThreadCount = 0;
+
     std::unordered_map<std::string, terminal::ColorPalette> colorschemes;
     std::unordered_map<std::string, TerminalProfile> profiles;
     std::string defaultProfileName;
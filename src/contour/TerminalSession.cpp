@@ -15,6 +15,7 @@
 #include <contour/helper.h>
 
 #include <terminal/Terminal.h>
+#include <terminal/TerminalScheduler.h>
 #include <terminal/pty/Pty.h>
 
 #include <range/v3/all.hpp>
@@ -65,6 +66,21 @@ namespace // {{{ helper
         return fmt::format("{}: Unhandled exception caught ({}). {}", where, typeid(e).name(), e.what());
     }
 
+    /// The I/O threads shared by all sessions.
+    ///
+    /// Owned by the sessions using it, so that the threads are created along with the first
+    /// such session and joined once the last one is gone, rather than during static destruction.
+    shared_ptr<TerminalScheduler> sharedScheduler(size_t _threadCount)
+    {
+        static weak_ptr<TerminalScheduler> scheduler;
+        if (auto existing = scheduler.lock())
+            return existing;
+
+        auto created = make_shared<TerminalScheduler>(_threadCount);
+        scheduler = created;
+        return created;
+    }
+
 } //  }}}
 
 TerminalSession::TerminalSession(unique_ptr<Pty> _pty,
@@ -97,6 +113,8 @@ TerminalSession::TerminalSession(unique_ptr<Pty> _pty,
     },
     display_{move(_display)}
 {
+    terminal_.setPtyReaderRingCapacity(config_.ptyReaderRingSize);
+
     if (_liveConfig)
     {
         debuglog(WidgetTag).write("Enable live configuration reloading of file {}.",
@@ -138,7 +156,13 @@ void TerminalSession::displayInitialized()
 
 void TerminalSession::start()
 {
-    terminal().start();
+    if (config_.ioThreadCount)
+    {
+        scheduler_ = sharedScheduler(config_.ioThreadCount);
+        terminal().start(*scheduler_);
+    }
+    else
+        terminal().start();
 }
 
 // {{{ Events implementations
@@ -450,7 +474,7 @@ void TerminalSession::operator()(actions::FollowHyperlink)
     };
     if (terminal().screen().contains(currentMousePosition))
     {
-        if (auto hyperlink = terminal().screen().at(currentMousePositionRel).hyperlink(); hyperlink != nullptr)
+        if (auto hyperlink = terminal().screen().hyperlinkAt(currentMousePositionRel); hyperlink != nullptr)
         {
             followHyperlink(*hyperlink);
             return;
@@ -764,6 +788,7 @@ void TerminalSession::configureTerminal()
     //     return;
 
     screen.setMaxHistoryLineCount(profile_.maxHistoryLineCount);
+    terminal_.setHistoryDiskQuota(profile_.historyDiskQuota); // under the terminal lock, see above
     terminal_.setCursorDisplay(profile_.cursorDisplay);
     terminal_.setCursorShape(profile_.cursorShape);
     terminal_.screen().colorPalette() = profile_.colors;
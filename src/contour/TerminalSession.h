@@ -165,6 +165,7 @@ class TerminalSession: public terminal::Terminal::Events
     std::function<void()> displayInitialized_;
 
     std::unique_ptr<terminal::Pty> pty_;
+    std::shared_ptr<terminal::TerminalScheduler> scheduler_; // must outlive terminal_
     terminal::Terminal terminal_;
     std::unique_ptr<TerminalDisplay> display_;
 
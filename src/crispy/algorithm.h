@@ -52,19 +52,19 @@ void copy(Container && _container, OutputIterator _outputIterator)
 template <typename Container, typename Fn>
 void for_each(Container && _container, Fn && _fn)
 {
-    std::for_each(begin(_container), end(_container), std::forward<Fn>(_fn));
+    std::for_each(std::begin(_container), std::end(_container), std::forward<Fn>(_fn));
 }
 
 template <typename ExecutionPolicy, typename Container, typename Fn>
 void for_each(ExecutionPolicy _ep, Container && _container, Fn && _fn)
 {
-    std::for_each(_ep, begin(_container), end(_container), std::forward<Fn>(_fn));
+    std::for_each(_ep, std::begin(_container), std::end(_container), std::forward<Fn>(_fn));
 }
 
 template <typename Container, typename T>
 auto count(Container&& _container, T&& _value)
 {
-    return std::count(begin(_container), end(_container), std::forward<T>(_value));
+    return std::count(std::begin(_container), std::end(_container), std::forward<T>(_value));
 }
 
 } // end namespace
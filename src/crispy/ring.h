@@ -0,0 +1,184 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace crispy {
+
+template <typename T> class ring;
+
+namespace detail {
+    template <typename Ring, typename T>
+    struct RingIterator {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_const_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        Ring* ring = nullptr;
+        difference_type current = 0;
+
+        // allows converting an iterator to a const_iterator
+        template <typename R, typename U, std::enable_if_t<std::is_convertible_v<U*, T*>, int> = 0>
+        constexpr RingIterator(RingIterator<R, U> const& _other) noexcept: ring{_other.ring}, current{_other.current} {}
+        constexpr RingIterator(Ring* _ring, difference_type _current) noexcept: ring{_ring}, current{_current} {}
+        constexpr RingIterator() noexcept = default;
+
+        reference operator*() const noexcept { return (*ring)[static_cast<size_t>(current)]; }
+        pointer operator->() const noexcept { return &**this; }
+        reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+        RingIterator& operator++() noexcept { ++current; return *this; }
+        RingIterator operator++(int) noexcept { auto old = *this; ++current; return old; }
+        RingIterator& operator--() noexcept { --current; return *this; }
+        RingIterator operator--(int) noexcept { auto old = *this; --current; return old; }
+
+        RingIterator& operator+=(difference_type n) noexcept { current += n; return *this; }
+        RingIterator& operator-=(difference_type n) noexcept { current -= n; return *this; }
+
+        RingIterator operator+(difference_type n) const noexcept { return RingIterator{ring, current + n}; }
+        RingIterator operator-(difference_type n) const noexcept { return RingIterator{ring, current - n}; }
+        friend RingIterator operator+(difference_type n, RingIterator a) noexcept { return a + n; }
+
+        difference_type operator-(RingIterator const& rhs) const noexcept { return current - rhs.current; }
+
+        bool operator==(RingIterator const& rhs) const noexcept { return current == rhs.current; }
+        bool operator!=(RingIterator const& rhs) const noexcept { return current != rhs.current; }
+        bool operator<(RingIterator const& rhs) const noexcept { return current < rhs.current; }
+        bool operator<=(RingIterator const& rhs) const noexcept { return current <= rhs.current; }
+        bool operator>(RingIterator const& rhs) const noexcept { return current > rhs.current; }
+        bool operator>=(RingIterator const& rhs) const noexcept { return current >= rhs.current; }
+    };
+}
+
+/**
+ * Sequence container with O(1) random access whose elements are stored in a ring.
+ *
+ * Rotating the ring (moving the front elements to the back) only moves the ring's zero index,
+ * so that the rotated elements can be recycled in place without touching the allocator.
+ *
+ * Appending elements while the ring is rotated first linearizes the underlying storage.
+ */
+template <typename T>
+class ring {
+  public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = detail::RingIterator<ring<T>, T>;
+    using const_iterator = detail::RingIterator<ring<T> const, T const>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    ring() = default;
+    ring(size_t _count, T const& _value): storage_(_count, _value) {}
+    ring(ring const&) = default;
+    ring(ring&&) noexcept = default;
+    ring& operator=(ring const&) = default;
+    ring& operator=(ring&&) noexcept = default;
+
+    size_t size() const noexcept { return storage_.size(); }
+    bool empty() const noexcept { return storage_.empty(); }
+
+    T& operator[](size_t i) noexcept { return storage_[(zero_ + i) % storage_.size()]; }
+    T const& operator[](size_t i) const noexcept { return storage_[(zero_ + i) % storage_.size()]; }
+
+    T& front() noexcept { return (*this)[0]; }
+    T const& front() const noexcept { return (*this)[0]; }
+    T& back() noexcept { return (*this)[size() - 1]; }
+    T const& back() const noexcept { return (*this)[size() - 1]; }
+
+    iterator begin() noexcept { return iterator{this, 0}; }
+    iterator end() noexcept { return iterator{this, static_cast<difference_type>(size())}; }
+    const_iterator begin() const noexcept { return cbegin(); }
+    const_iterator end() const noexcept { return cend(); }
+    const_iterator cbegin() const noexcept { return const_iterator{this, 0}; }
+    const_iterator cend() const noexcept { return const_iterator{this, static_cast<difference_type>(size())}; }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+    reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{cend()}; }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator{cbegin()}; }
+
+    /// Moves the first @p _count elements to the back, in O(1).
+    void rotate_left(size_t _count) noexcept
+    {
+        if (!storage_.empty())
+            zero_ = (zero_ + _count) % storage_.size();
+    }
+
+    /// Moves the last @p _count elements to the front, in O(1).
+    void rotate_right(size_t _count) noexcept
+    {
+        if (!storage_.empty())
+            zero_ = (zero_ + storage_.size() - _count % storage_.size()) % storage_.size();
+    }
+
+    void push_back(T const& _value) { linearize(); storage_.push_back(_value); }
+    void push_back(T&& _value) { linearize(); storage_.push_back(std::move(_value)); }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... _args)
+    {
+        linearize();
+        return storage_.emplace_back(std::forward<Args>(_args)...);
+    }
+
+    /// Removes the first @p _count elements.
+    void erase_front(size_t _count)
+    {
+        linearize();
+        storage_.erase(storage_.begin(), std::next(storage_.begin(), static_cast<difference_type>(_count)));
+    }
+
+    void resize(size_t _count)
+    {
+        linearize();
+        storage_.resize(_count);
+    }
+
+    void reserve(size_t _capacity) { storage_.reserve(_capacity); }
+
+    void clear() noexcept
+    {
+        storage_.clear();
+        zero_ = 0;
+    }
+
+  private:
+    /// Rearranges the underlying storage such that the logical front is also the physical front.
+    void linearize()
+    {
+        if (zero_ == 0)
+            return;
+
+        std::rotate(storage_.begin(), std::next(storage_.begin(), static_cast<difference_type>(zero_)), storage_.end());
+        zero_ = 0;
+    }
+
+    std::vector<T> storage_;
+    size_t zero_ = 0;
+};
+
+} // end namespace
@@ -0,0 +1,95 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <crispy/ring.h>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+    template <typename T>
+    vector<T> toVector(crispy::ring<T> const& _ring)
+    {
+        return vector<T>(_ring.begin(), _ring.end());
+    }
+}
+
+TEST_CASE("ring.push_back")
+{
+    crispy::ring<int> r;
+    r.push_back(1);
+    r.push_back(2);
+    r.emplace_back(3);
+    CHECK(r.size() == 3);
+    CHECK(r.front() == 1);
+    CHECK(r.back() == 3);
+    CHECK(toVector(r) == vector{1, 2, 3});
+}
+
+TEST_CASE("ring.rotate_left")
+{
+    crispy::ring<int> r;
+    for (int i = 1; i <= 5; ++i)
+        r.push_back(i);
+
+    r.rotate_left(2);
+    CHECK(toVector(r) == vector{3, 4, 5, 1, 2});
+    CHECK(r[0] == 3);
+    CHECK(r.back() == 2);
+
+    r.rotate_right(3);
+    CHECK(toVector(r) == vector{5, 1, 2, 3, 4});
+}
+
+TEST_CASE("ring.push_back_after_rotate")
+{
+    crispy::ring<int> r;
+    for (int i = 1; i <= 4; ++i)
+        r.push_back(i);
+
+    r.rotate_left(1);
+    r.push_back(5);
+    CHECK(toVector(r) == vector{2, 3, 4, 1, 5});
+}
+
+TEST_CASE("ring.erase_front")
+{
+    crispy::ring<int> r;
+    for (int i = 1; i <= 5; ++i)
+        r.push_back(i);
+
+    r.rotate_left(3);
+    r.erase_front(2);
+    CHECK(toVector(r) == vector{1, 2, 3});
+}
+
+TEST_CASE("ring.iterator")
+{
+    crispy::ring<int> r;
+    for (int i = 1; i <= 5; ++i)
+        r.push_back(i);
+    r.rotate_left(2);
+
+    CHECK(r.end() - r.begin() == 5);
+    CHECK(*next(r.begin(), 4) == 2);
+    CHECK(*r.rbegin() == 2);
+
+    // std algorithms operate on the logical order
+    std::rotate(r.begin(), next(r.begin(), 1), r.end());
+    CHECK(toVector(r) == vector{4, 5, 1, 2, 3});
+}
@@ -0,0 +1,137 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <crispy/span.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace crispy {
+
+/**
+ * Lock-free ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * The producer fills the contiguous free space returned by write_window() in place and
+ * publishes it via commit(), the consumer processes the contiguous filled space returned by
+ * read_window() in place and releases it via consume(). Neither side ever blocks, so waiting
+ * for data (or space) is left to the caller.
+ *
+ * The capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class spsc_ring {
+  public:
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    explicit spsc_ring(size_t _capacity):
+        capacity_{ roundUpToPowerOfTwo(std::max(_capacity, size_t{1})) },
+        data_{ std::make_unique<T[]>(capacity_) }
+    {}
+
+    spsc_ring(spsc_ring const&) = delete;
+    spsc_ring& operator=(spsc_ring const&) = delete;
+
+    size_t capacity() const noexcept { return capacity_; }
+
+    /// Number of elements available to the consumer, which may be outdated immediately
+    /// when invoked from anywhere else than the producer or consumer thread.
+    size_t size() const noexcept { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+    bool empty() const noexcept { return size() == 0; }
+    bool full() const noexcept { return size() == capacity_; }
+
+    // {{{ producer side
+    /// @returns the contiguous free space at the ring's head, which may be shorter than the total
+    ///          free space if it wraps around the end of the underlying storage.
+    span<T> write_window() noexcept
+    {
+        auto const head = head_.load(std::memory_order_relaxed);
+        auto const tail = tail_.load(std::memory_order_acquire);
+        auto const offset = head & (capacity_ - 1);
+        auto const count = std::min(capacity_ - (head - tail), capacity_ - offset);
+        return span<T>(data_.get() + offset, count);
+    }
+
+    /// Publishes the first @p _count elements of the last write_window() to the consumer.
+    void commit(size_t _count) noexcept
+    {
+        assert(_count <= write_window().size());
+        head_.store(head_.load(std::memory_order_relaxed) + _count, std::memory_order_release);
+    }
+
+    /// Copies as many elements of @p _data into the ring as there is free space for.
+    ///
+    /// @returns the number of elements copied.
+    size_t write(T const* _data, size_t _count) noexcept
+    {
+        auto written = size_t{0};
+        while (written < _count)
+        {
+            auto window = write_window();
+            if (window.empty())
+                break;
+            auto const n = std::min(window.size(), _count - written);
+            std::copy_n(_data + written, n, window.begin());
+            commit(n);
+            written += n;
+        }
+        return written;
+    }
+    // }}}
+
+    // {{{ consumer side
+    /// @returns the contiguous filled space at the ring's tail, which may be shorter than size()
+    ///          if it wraps around the end of the underlying storage.
+    span<T const> read_window() const noexcept
+    {
+        auto const tail = tail_.load(std::memory_order_relaxed);
+        auto const head = head_.load(std::memory_order_acquire);
+        auto const offset = tail & (capacity_ - 1);
+        auto const count = std::min(head - tail, capacity_ - offset);
+        return span<T const>(data_.get() + offset, count);
+    }
+
+    /// Releases the first @p _count elements of the last read_window() to the producer.
+    void consume(size_t _count) noexcept
+    {
+        assert(_count <= read_window().size());
+        tail_.store(tail_.load(std::memory_order_relaxed) + _count, std::memory_order_release);
+    }
+    // }}}
+
+  private:
+    static size_t roundUpToPowerOfTwo(size_t _value) noexcept
+    {
+        auto result = size_t{1};
+        while (result < _value)
+            result <<= 1;
+        return result;
+    }
+
+    size_t const capacity_;
+    std::unique_ptr<T[]> data_;
+
+    // Both indices grow monotonically and are only masked when accessing data_,
+    // so that a full ring can be told apart from an empty one.
+    // They live on separate cache lines, as each of them is written by another thread.
+    alignas(64) std::atomic<size_t> head_ = 0; // written by the producer
+    alignas(64) std::atomic<size_t> tail_ = 0; // written by the consumer
+};
+
+}
@@ -0,0 +1,95 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <crispy/spsc_ring.h>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+namespace
+{
+    string_view view(crispy::span<char const> _span)
+    {
+        return string_view(_span.begin(), _span.size());
+    }
+}
+
+TEST_CASE("spsc_ring.capacity")
+{
+    CHECK(crispy::spsc_ring<char>(0).capacity() == 1);
+    CHECK(crispy::spsc_ring<char>(8).capacity() == 8);
+    CHECK(crispy::spsc_ring<char>(9).capacity() == 16);
+}
+
+TEST_CASE("spsc_ring.write_and_consume")
+{
+    crispy::spsc_ring<char> ring(8);
+    CHECK(ring.empty());
+
+    CHECK(ring.write("abcdef", 6) == 6);
+    CHECK(ring.size() == 6);
+    CHECK(view(ring.read_window()) == "abcdef");
+
+    ring.consume(4);
+    CHECK(view(ring.read_window()) == "ef");
+
+    // Only as much as fits, split at the end of the storage.
+    CHECK(ring.write("ghijklmn", 8) == 6);
+    CHECK(ring.full());
+    CHECK(ring.write_window().empty());
+    CHECK(view(ring.read_window()) == "efgh");
+
+    ring.consume(4);
+    CHECK(view(ring.read_window()) == "ijkl");
+    ring.consume(4);
+    CHECK(ring.empty());
+    CHECK(ring.read_window().empty());
+}
+
+TEST_CASE("spsc_ring.threads")
+{
+    auto constexpr Total = size_t{1000000};
+
+    crispy::spsc_ring<char> ring(64);
+    auto producer = thread([&]() {
+        for (size_t i = 0; i < Total; )
+        {
+            auto window = ring.write_window();
+            auto const n = min(window.size(), Total - i);
+            for (size_t k = 0; k < n; ++k)
+                window[k] = static_cast<char>((i + k) % 251);
+            ring.commit(n);
+            i += n;
+        }
+    });
+
+    auto mismatches = size_t{0};
+    for (size_t i = 0; i < Total; )
+    {
+        auto const window = ring.read_window();
+        for (size_t k = 0; k < window.size(); ++k)
+            if (window[k] != static_cast<char>((i + k) % 251))
+                ++mismatches;
+        ring.consume(window.size());
+        i += window.size();
+    }
+    producer.join();
+
+    CHECK(mismatches == 0);
+    CHECK(ring.empty());
+}
@@ -69,6 +69,12 @@ class CharsetMapping {
 
     constexpr CharsetTable currentTable() const noexcept { return shift_; }
 
+    /// @returns whether US-ASCII characters are currently mapped to themselves.
+    bool isIdentity() const noexcept
+    {
+        return tables_[static_cast<size_t>(shift_)] == charsetMap(CharsetId::USASCII);
+    }
+
   private:
     CharsetTable shift_ = CharsetTable::G0;
     CharsetTable selected_ = CharsetTable::G0;
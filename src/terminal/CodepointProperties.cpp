@@ -0,0 +1,145 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/CodepointProperties.h>
+
+#include <unicode/grapheme_segmenter.h>
+#include <unicode/width.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+using std::array;
+using std::vector;
+
+namespace terminal {
+
+namespace {
+    struct Range {
+        char32_t from;
+        char32_t to;
+    };
+
+    /// Codepoint ranges of grapheme cluster break property Other that contain no
+    /// Extended_Pictographic and no Prepend codepoints (UAX #29).
+    ///
+    /// Combining marks, Hangul, emoji, and the like are intentionally left out
+    /// and thus always passed on to libunicode.
+    constexpr Range alwaysBreakingRanges[] = {
+        { 0x0020, 0x007E },   // Basic Latin
+        { 0x00A0, 0x00A8 },   // Latin-1 Supplement, except for ©, SHY, ®
+        { 0x00AA, 0x00AC },
+        { 0x00AF, 0x02FF },   // ... Latin Extended, IPA, Spacing Modifier Letters
+        { 0x0370, 0x0482 },   // Greek and Coptic, Cyrillic
+        { 0x048A, 0x052F },   // Cyrillic, Cyrillic Supplement
+        { 0x3000, 0x3029 },   // CJK Symbols and Punctuation
+        { 0x3041, 0x3096 },   // Hiragana
+        { 0x309B, 0x30FF },   // Hiragana, Katakana
+        { 0x3400, 0x4DBF },   // CJK Unified Ideographs Extension A
+        { 0x4E00, 0x9FFF },   // CJK Unified Ideographs
+        { 0xF900, 0xFAFF },   // CJK Compatibility Ideographs
+        { 0xFF01, 0xFF60 },   // Fullwidth Forms
+        { 0x20000, 0x3FFFD }, // CJK Unified Ideographs Extension B and later
+    };
+}
+
+/// Two-level codepoint property table.
+class CodepointTable {
+  public:
+    static constexpr unsigned BlockBits = 8;
+    static constexpr unsigned BlockSize = 1u << BlockBits;
+    static constexpr char32_t Limit = 0x40000; // planes 0 to 3
+
+    static CodepointTable const& get()
+    {
+        static CodepointTable const table;
+        return table;
+    }
+
+    CodepointProperties operator[](char32_t _codepoint) const noexcept
+    {
+        auto const block = blockIndex_[_codepoint >> BlockBits];
+        return blocks_[block * BlockSize + (_codepoint & (BlockSize - 1))];
+    }
+
+  private:
+    CodepointTable()
+    {
+        auto const alwaysBreaks = [](char32_t _codepoint) {
+            return std::any_of(std::begin(alwaysBreakingRanges), std::end(alwaysBreakingRanges),
+                               [&](Range const& _range) { return _range.from <= _codepoint && _codepoint <= _range.to; });
+        };
+
+        auto block = array<CodepointProperties, BlockSize>{};
+        for (char32_t blockStart = 0; blockStart < Limit; blockStart += BlockSize)
+        {
+            for (char32_t i = 0; i < BlockSize; ++i)
+                block[i] = properties(blockStart + i, alwaysBreaks(blockStart + i));
+
+            // Most blocks are identical to a previous one (e.g. unassigned or all of width 1).
+            auto const blockCount = blocks_.size() / BlockSize;
+            auto index = size_t{0};
+            while (index < blockCount
+                && std::memcmp(&blocks_[index * BlockSize], block.data(), sizeof(block)) != 0)
+                ++index;
+
+            if (index == blockCount)
+                blocks_.insert(blocks_.end(), block.begin(), block.end());
+
+            blockIndex_[blockStart >> BlockBits] = static_cast<uint16_t>(index);
+        }
+        blocks_.shrink_to_fit();
+    }
+
+    static CodepointProperties properties(char32_t _codepoint, bool _alwaysBreaks) noexcept
+    {
+        auto const width = std::clamp(unicode::width(_codepoint), 0, 3);
+        return CodepointProperties(static_cast<uint8_t>(width | (_alwaysBreaks ? CodepointProperties::AlwaysBreaks : 0)));
+    }
+
+    array<uint16_t, Limit / BlockSize> blockIndex_{};
+    vector<CodepointProperties> blocks_;
+};
+
+CodepointProperties CodepointProperties::get(char32_t _codepoint) noexcept
+{
+    if (_codepoint < CodepointTable::Limit)
+        return CodepointTable::get()[_codepoint];
+
+    auto const width = std::clamp(unicode::width(_codepoint), 0, 3);
+    return CodepointProperties(static_cast<uint8_t>(width));
+}
+
+int codepointWidth(char32_t _codepoint) noexcept
+{
+    if (_codepoint < CodepointTable::Limit)
+        return CodepointTable::get()[_codepoint].width();
+
+    return unicode::width(_codepoint);
+}
+
+bool graphemeNonbreakable(char32_t _a, char32_t _b) noexcept
+{
+    if (_a < CodepointTable::Limit && _b < CodepointTable::Limit)
+    {
+        auto const& table = CodepointTable::get();
+        if (table[_a].alwaysBreaks() && table[_b].alwaysBreaks())
+            return false;
+    }
+
+    return unicode::grapheme_segmenter::nonbreakable(_a, _b);
+}
+
+} // end namespace
@@ -0,0 +1,58 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace terminal {
+
+/// Codepoint properties needed for every printed character, packed into a single byte.
+///
+/// Properties are looked up in a two-level table (256 codepoints per block, identical
+/// blocks shared) that is built from libunicode on first use and covers the planes 0 to 3.
+/// Its first block doubles as direct table for Latin-1.
+/// Codepoints beyond that range are passed on to libunicode.
+class CodepointProperties {
+  public:
+    static CodepointProperties get(char32_t _codepoint) noexcept;
+
+    /// @returns the same as unicode::width(), clamped to 0..3.
+    int width() const noexcept { return value_ & WidthMask; }
+
+    /// Whether the codepoint is of grapheme cluster break property Other and neither
+    /// Extended_Pictographic nor Prepend, so that there is always a cluster boundary
+    /// between two such codepoints.
+    bool alwaysBreaks() const noexcept { return value_ & AlwaysBreaks; }
+
+    constexpr CodepointProperties() noexcept = default;
+    constexpr explicit CodepointProperties(uint8_t _value) noexcept : value_{_value} {}
+
+  private:
+    static constexpr uint8_t WidthMask = 0x03;
+    static constexpr uint8_t AlwaysBreaks = 0x80;
+
+    friend class CodepointTable;
+
+    uint8_t value_ = 0;
+};
+
+/// @returns the same as unicode::width(_codepoint).
+int codepointWidth(char32_t _codepoint) noexcept;
+
+/// @returns the same as unicode::grapheme_segmenter::nonbreakable(_a, _b), but without
+///          consulting libunicode for the common case of consecutive Latin, Greek,
+///          Cyrillic, or CJK characters.
+bool graphemeNonbreakable(char32_t _a, char32_t _b) noexcept;
+
+} // end namespace
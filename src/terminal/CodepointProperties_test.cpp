@@ -0,0 +1,63 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/CodepointProperties.h>
+
+#include <unicode/grapheme_segmenter.h>
+#include <unicode/width.h>
+
+#include <catch2/catch.hpp>
+
+#include <fmt/format.h>
+
+#include <array>
+
+using namespace terminal;
+
+TEST_CASE("CodepointProperties.width")
+{
+    char32_t mismatch = 0;
+    for (char32_t codepoint = 1; codepoint <= 0x10FFFF && !mismatch; ++codepoint)
+        if (codepointWidth(codepoint) != unicode::width(codepoint))
+            mismatch = codepoint;
+
+    INFO(fmt::format("U+{:04X}", static_cast<uint32_t>(mismatch)));
+    CHECK(mismatch == 0);
+
+    CHECK(CodepointProperties::get(U'A').width() == 1);
+    CHECK(CodepointProperties::get(U'\u3042').width() == 2);      // HIRAGANA LETTER A
+    CHECK(CodepointProperties::get(U'\u0301').width() == 0);      // COMBINING ACUTE ACCENT
+    CHECK(CodepointProperties::get(U'\U0001F600').width() == 2);  // GRINNING FACE
+}
+
+TEST_CASE("CodepointProperties.graphemeNonbreakable")
+{
+    auto constexpr samples = std::array{
+        U' ', U'A', U'z', U'\u00A9', U'\u00E4', U'\u0301', U'\u0416', U'\u0600', U'\u093E',
+        U'\u1100', U'\u1161', U'\u200D', U'\u3042', U'\u3099', U'\u30A2', U'\u4E2D', U'\uAC00',
+        U'\uFE0F', U'\uFF21', U'\uFF9E', U'\U0001F1E9', U'\U0001F1EA', U'\U0001F3FC', U'\U0001F600',
+        U'\U00020000', U'\U000E0061',
+    };
+
+    for (char32_t const a: samples)
+        for (char32_t const b: samples)
+        {
+            INFO(fmt::format("U+{:04X} U+{:04X}", static_cast<uint32_t>(a), static_cast<uint32_t>(b)));
+            CHECK(graphemeNonbreakable(a, b) == unicode::grapheme_segmenter::nonbreakable(a, b));
+        }
+
+    CHECK(CodepointProperties::get(U'\u4E2D').alwaysBreaks());
+    CHECK_FALSE(CodepointProperties::get(U'\u0301').alwaysBreaks());
+    CHECK_FALSE(CodepointProperties::get(U'\u00A9').alwaysBreaks()); // Extended_Pictographic
+    CHECK_FALSE(CodepointProperties::get(U'\u0600').alwaysBreaks()); // Prepend
+}
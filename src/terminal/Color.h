@@ -169,7 +169,13 @@ struct Color
 
 constexpr bool operator==(Color a, Color b) noexcept
 {
-    return a.type == b.type && a.index == b.index;
+    if (a.type != b.type)
+        return false;
+
+    if (a.type == ColorType::RGB)
+        return a.rgb == b.rgb;
+
+    return a.index == b.index;
 }
 
 constexpr bool operator!=(Color a, Color b) noexcept
@@ -280,6 +286,25 @@ struct ColorPalette
     } hyperlinkDecoration;
 };
 
+inline bool operator==(ColorPalette const& a, ColorPalette const& b) noexcept
+{
+    return a.palette == b.palette
+        && a.defaultForeground == b.defaultForeground
+        && a.defaultBackground == b.defaultBackground
+        && a.selectionForeground == b.selectionForeground
+        && a.selectionBackground == b.selectionBackground
+        && a.cursor == b.cursor
+        && a.mouseForeground == b.mouseForeground
+        && a.mouseBackground == b.mouseBackground
+        && a.hyperlinkDecoration.normal == b.hyperlinkDecoration.normal
+        && a.hyperlinkDecoration.hover == b.hyperlinkDecoration.hover;
+}
+
+inline bool operator!=(ColorPalette const& a, ColorPalette const& b) noexcept
+{
+    return !(a == b);
+}
+
 enum class ColorTarget {
     Foreground,
     Background,
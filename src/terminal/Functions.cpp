@@ -25,9 +25,11 @@
 
 #include <array>
 #include <algorithm>
+#include <cassert>
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <vector>
 
 using crispy::times;
 using crispy::for_each;
@@ -43,20 +45,104 @@ using std::stringstream;
 
 namespace terminal {
 
+namespace
+{
+    /// Direct-indexed lookup of all functions sharing the same category, leader,
+    /// intermediate, and final character, so that selecting a function only needs
+    /// to tell those few candidates apart by their parameter count.
+    class FunctionIndex
+    {
+      public:
+        struct Range
+        {
+            uint16_t first = 0;
+            uint16_t count = 0;
+        };
+
+        static FunctionIndex const& get()
+        {
+            static FunctionIndex const index;
+            return index;
+        }
+
+        Range find(FunctionCategory _category, char _leader, char _intermediate, char _final) const noexcept
+        {
+            auto const key = slot(_category, _leader, _intermediate);
+            auto const finalIndex = static_cast<unsigned char>(_final);
+            if (key == InvalidSlot || finalIndex >= FinalCount || !groups_[key])
+                return Range{};
+
+            return ranges_[(groups_[key] - 1u) * FinalCount + finalIndex];
+        }
+
+      private:
+        static constexpr size_t LeaderCount = 5;        // none, or one of: < = > ?
+        static constexpr size_t IntermediateCount = 17; // none, or 0x20..0x2F
+        static constexpr size_t FinalCount = 0x80;
+        static constexpr size_t SlotCount = 5 * LeaderCount * IntermediateCount;
+        static constexpr size_t InvalidSlot = SlotCount;
+
+        static constexpr size_t slot(FunctionCategory _category, char _leader, char _intermediate) noexcept
+        {
+            auto const leader = !_leader ? 0u
+                              : 0x3C <= _leader && _leader <= 0x3F ? static_cast<size_t>(_leader - 0x3C + 1)
+                              : LeaderCount;
+            auto const intermediate = !_intermediate ? 0u
+                                    : 0x20 <= _intermediate && _intermediate <= 0x2F ? static_cast<size_t>(_intermediate - 0x20 + 1)
+                                    : IntermediateCount;
+            if (leader == LeaderCount || intermediate == IntermediateCount)
+                return InvalidSlot;
+
+            return (static_cast<size_t>(_category) * LeaderCount + leader) * IntermediateCount + intermediate;
+        }
+
+        FunctionIndex()
+        {
+            auto const& funcs = functions();
+            for (size_t i = 0; i < funcs.size(); ++i)
+            {
+                auto const& f = funcs[i];
+                auto const key = slot(f.category, f.leader, f.intermediate);
+                auto const finalIndex = static_cast<unsigned char>(f.finalSymbol);
+                assert(key != InvalidSlot && finalIndex < FinalCount);
+
+                if (!groups_[key])
+                {
+                    ranges_.resize(ranges_.size() + FinalCount);
+                    groups_[key] = static_cast<uint8_t>(ranges_.size() / FinalCount);
+                }
+
+                // functions() is sorted, so all candidates of one range are adjacent.
+                auto& range = ranges_[(groups_[key] - 1u) * FinalCount + finalIndex];
+                if (!range.count)
+                    range.first = static_cast<uint16_t>(i);
+                range.count++;
+            }
+        }
+
+        std::array<uint8_t, SlotCount> groups_{}; // 0 for none, otherwise 1-based group number
+        std::vector<Range> ranges_;               // FinalCount ranges per group
+    };
+}
+
 FunctionDefinition const* select(FunctionSelector const& _selector) noexcept
 {
     auto static const& funcs = functions();
+    auto const range = FunctionIndex::get().find(_selector.category,
+                                                 _selector.leader,
+                                                 _selector.intermediate,
+                                                 _selector.finalSymbol);
 
-    //std::cout << fmt::format("select: {}\n", _selector);
+    //std::cout << fmt::format("select: {} ({} candidates)\n", _selector, range.count);
 
-    int a = 0;
-    int b = static_cast<int>(funcs.size()) - 1;
+    // Candidates only differ in their parameter count (or OSC code).
+    int a = range.first;
+    int b = range.first + range.count - 1;
     while (a <= b)
     {
         auto const i = (a + b) / 2;
         auto const& I = funcs[i];
         auto const rel = compare(_selector, I);
-        //std::cout << fmt::format(" - a:{:>2} b:{:>2} i:{} rel:{} I: {}\n", a, b, i, rel < 0 ? '<' : rel > 0 ? '>' : '=', I);
         if (rel > 0)
             a = i + 1;
         else if (rel < 0)
@@ -70,3 +70,22 @@ TEST_CASE("Functions.OSC777", "[Functions]")
     REQUIRE(osc);
     CHECK(*osc == NOTIFY);
 }
+
+TEST_CASE("Functions.select_all", "[Functions]")
+{
+    for (FunctionDefinition const& f: functions())
+    {
+        auto const argc = f.category == FunctionCategory::OSC ? f.maximumParameters : f.minimumParameters;
+        auto const selector = FunctionSelector{f.category, f.leader, argc, f.intermediate, f.finalSymbol};
+        INFO(fmt::format("{}", f));
+
+        FunctionDefinition const* g = select(selector);
+        REQUIRE(g);
+        CHECK(compare(selector, *g) == 0);
+    }
+
+    CHECK(selectControl(0, 0, 0, 'x') == nullptr);
+    CHECK(selectControl('?', 0, 0, 'h') == nullptr); // DECSM requires at least one mode
+    CHECK(selectControl('!', 0, 0, 'h') == nullptr);
+    CHECK(selectControl(0, 0, '\x7F', 'h') == nullptr);
+}
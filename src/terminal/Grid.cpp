@@ -12,6 +12,7 @@
  * limitations under the License.
  */
 #include <terminal/Grid.h>
+#include <terminal/logging.h>
 
 #include <crispy/Comparison.h>
 #include <crispy/indexed.h>
@@ -30,6 +31,7 @@ using crispy::Comparison;
 using crispy::Size;
 
 using std::back_inserter;
+using std::copy_n;
 using std::fill_n;
 using std::for_each;
 using std::front_inserter;
@@ -60,7 +62,7 @@ namespace // {{{ helper
     {
         return
 #if defined(LIBTERMINAL_IMAGES)
-            !_cell.imageFragment() &&
+            !_cell.imageId() &&
 #endif
             _cell.codepointCount() == 0;
     }
@@ -72,13 +74,218 @@ namespace // {{{ helper
         std::cout << fmt::format(std::forward<Args>(_args)...) << '\n';
 #endif
     }
+
+    // {{{ compressed line encoding
+    // Tags prefixing an encoded cell. Any other byte is the lead byte of a single
+    // UTF-8 encoded codepoint (>= U+0020), which never collides with these tags.
+    constexpr uint8_t EmptyCellTag = 0x00;   // empty cell
+    constexpr uint8_t ClusterCellTag = 0x01; // followed by codepoint count and the UTF-8 encoded codepoints
+    constexpr uint8_t WidthTag = 0x02;       // followed by the cell's width, overriding the natural width
+
+    void writeVarint(Line::CompressedBuffer& _out, uint32_t _value)
+    {
+        while (_value >= 0x80)
+        {
+            _out.push_back(static_cast<uint8_t>(_value | 0x80));
+            _value >>= 7;
+        }
+        _out.push_back(static_cast<uint8_t>(_value));
+    }
+
+    uint32_t readVarint(uint8_t const*& _in) noexcept
+    {
+        uint32_t value = 0;
+        for (unsigned shift = 0; ; shift += 7)
+        {
+            auto const byte = *_in++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+    }
+
+    void writeUtf8(Line::CompressedBuffer& _out, char32_t _codepoint)
+    {
+        if (_codepoint < 0x80)
+            _out.push_back(static_cast<uint8_t>(_codepoint));
+        else if (_codepoint < 0x800)
+        {
+            _out.push_back(static_cast<uint8_t>(0xC0 | (_codepoint >> 6)));
+            _out.push_back(static_cast<uint8_t>(0x80 | (_codepoint & 0x3F)));
+        }
+        else if (_codepoint < 0x10000)
+        {
+            _out.push_back(static_cast<uint8_t>(0xE0 | (_codepoint >> 12)));
+            _out.push_back(static_cast<uint8_t>(0x80 | ((_codepoint >> 6) & 0x3F)));
+            _out.push_back(static_cast<uint8_t>(0x80 | (_codepoint & 0x3F)));
+        }
+        else
+        {
+            _out.push_back(static_cast<uint8_t>(0xF0 | (_codepoint >> 18)));
+            _out.push_back(static_cast<uint8_t>(0x80 | ((_codepoint >> 12) & 0x3F)));
+            _out.push_back(static_cast<uint8_t>(0x80 | ((_codepoint >> 6) & 0x3F)));
+            _out.push_back(static_cast<uint8_t>(0x80 | (_codepoint & 0x3F)));
+        }
+    }
+
+    char32_t readUtf8(uint8_t const*& _in) noexcept
+    {
+        auto const lead = *_in++;
+        auto const [length, initial] = lead < 0x80 ? tuple{0, char32_t(lead)}
+                                     : lead < 0xE0 ? tuple{1, char32_t(lead & 0x1F)}
+                                     : lead < 0xF0 ? tuple{2, char32_t(lead & 0x0F)}
+                                                   : tuple{3, char32_t(lead & 0x07)};
+        char32_t codepoint = initial;
+        for (int i = 0; i < length; ++i)
+            codepoint = (codepoint << 6) | (*_in++ & 0x3F);
+        return codepoint;
+    }
+
+    /// Writes the runs of equal values of @p _value(i) for all i in [0, _count).
+    template <typename F>
+    void writeRuns(Line::CompressedBuffer& _out, size_t _count, F _value)
+    {
+        uint32_t runCount = 0;
+        for (size_t i = 0; i < _count; ++i)
+            if (i == 0 || _value(i) != _value(i - 1))
+                ++runCount;
+        writeVarint(_out, runCount);
+
+        for (size_t start = 0, i = 1; start < _count; ++i)
+        {
+            if (i == _count || _value(i) != _value(start))
+            {
+                writeVarint(_out, static_cast<uint32_t>(i - start));
+                writeVarint(_out, static_cast<uint32_t>(_value(start)));
+                start = i;
+            }
+        }
+    }
+
+    /// Reads runs as written by writeRuns(), invoking @p _assign(i, value) for every index.
+    template <typename F>
+    void readRuns(uint8_t const*& _in, F _assign)
+    {
+        size_t i = 0;
+        for (auto runCount = readVarint(_in); runCount != 0; --runCount)
+        {
+            auto const length = readVarint(_in);
+            auto const value = readVarint(_in);
+            for (uint32_t k = 0; k < length; ++k)
+                _assign(i++, value);
+        }
+    }
+
+    /// Invokes @p _callback with the graphics attributes Id of each attribute run of the given compressed line.
+    template <typename F>
+    void forEachAttributesRun(uint8_t const* _in, F _callback)
+    {
+        readVarint(_in); // cell count
+        _callback(static_cast<GraphicsAttributesId>(readVarint(_in))); // fill cell
+#if defined(LIBTERMINAL_HYPERLINKS)
+        readVarint(_in); // fill cell's hyperlink
+#endif
+        for (auto runCount = readVarint(_in); runCount != 0; --runCount)
+        {
+            readVarint(_in); // run length
+            _callback(static_cast<GraphicsAttributesId>(readVarint(_in)));
+        }
+    }
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+    /// Invokes @p _callback with the hyperlink Id of each hyperlink run of the given compressed line.
+    template <typename F>
+    void forEachHyperlinkRun(uint8_t const* _in, F _callback)
+    {
+        readVarint(_in); // cell count
+        readVarint(_in); // fill cell's attributes
+        _callback(static_cast<HyperlinkId>(readVarint(_in))); // fill cell
+        for (auto runCount = readVarint(_in); runCount != 0; --runCount)
+        {
+            readVarint(_in); // run length
+            readVarint(_in); // attributes
+        }
+        for (auto runCount = readVarint(_in); runCount != 0; --runCount)
+        {
+            readVarint(_in); // run length
+            _callback(static_cast<HyperlinkId>(readVarint(_in)));
+        }
+    }
+#endif
+
+    /// Tests whether the given cell can be used to fill the trailing columns of a line.
+    bool isFillable(Cell const& _cell) noexcept
+    {
+        return _cell.codepointCount() == 0
+            && _cell.imageId() == 0
+            && _cell.width() == 1;
+    }
+
+    /// Tests whether the given cell is equivalent to the given fill cell.
+    bool isFill(Cell const& _cell, Cell const& _fill) noexcept
+    {
+        return isFillable(_cell)
+            && _cell.attributesId() == _fill.attributesId()
+#if defined(LIBTERMINAL_HYPERLINKS)
+            && _cell.hyperlink() == _fill.hyperlink()
+#endif
+            ;
+    }
+
+    /// Decodes the cells of a compressed line of @p _columns columns into @p _storage.
+    Line::Buffer decodeCells(uint8_t const* _in, int _columns, GraphemeClusterStore& _clusters, Line::Buffer&& _storage)
+    {
+        auto in = _in;
+        auto const cellCount = readVarint(in);
+        auto fill = Cell{{}, static_cast<GraphicsAttributesId>(readVarint(in))};
+#if defined(LIBTERMINAL_HYPERLINKS)
+        fill.setHyperlink(readVarint(in));
+#endif
+
+        auto cells = move(_storage);
+        cells.assign(static_cast<size_t>(_columns), fill);
+
+        readRuns(in, [&](size_t i, uint32_t _id) { cells[i].setAttributes(static_cast<GraphicsAttributesId>(_id)); });
+#if defined(LIBTERMINAL_HYPERLINKS)
+        readRuns(in, [&](size_t i, uint32_t _id) { cells[i].setHyperlink(_id); });
+#endif
+
+        for (Cell& cell : crispy::range(cells.begin(), next(cells.begin(), cellCount)))
+        {
+            optional<int> width;
+            if (*in == WidthTag)
+            {
+                width = in[1];
+                in += 2;
+            }
+
+            if (*in == EmptyCellTag)
+                ++in;
+            else if (*in == ClusterCellTag)
+            {
+                auto const count = in[1];
+                in += 2;
+                cell.setCharacter(readUtf8(in));
+                for (int i = 1; i < count; ++i)
+                    cell.appendCharacter(readUtf8(in), _clusters);
+            }
+            else
+                cell.setCharacter(readUtf8(in));
+
+            if (width)
+                cell.setWidth(*width);
+        }
+
+        return cells;
+    }
+    // }}}
 }
 // }}}
 // {{{ Cell impl
-string Cell::toUtf8() const
+string Cell::toUtf8(GraphemeClusterStore const& _clusters) const
 {
-    if (!codepoints_.empty())
-        return unicode::convert_to<char>(codepoints());
+    if (codepointCount_ != 0)
+        return unicode::convert_to<char>(codepoints(_clusters));
     else
         return " ";
 }
@@ -110,27 +317,29 @@ Line::Line(int _numCols, std::string_view const& _s, Flags _flags) :
         buffer_.at(i).setCharacter(ch);
 }
 
-string Line::toUtf8() const
+string Line::toUtf8(GraphemeClusterStore const& _clusters) const
 {
     std::stringstream sstr;
-    for (Cell const& cell : crispy::range(begin(), next(begin(), size())))
+    for (int column = 0; column < size(); ++column)
     {
+        // Trimmed lines store fewer cells than their size.
+        Cell const& cell = at(static_cast<size_t>(column));
         if (cell.codepointCount() == 0)
         {
             sstr << ' ';
         }
         else
         {
-            for (char32_t codepoint : cell.codepoints())
+            for (char32_t codepoint : cell.codepoints(_clusters))
                 sstr << unicode::convert_to<char>(codepoint);
         }
     }
     return sstr.str();
 }
 
-string Line::toUtf8Trimmed() const
+string Line::toUtf8Trimmed(GraphemeClusterStore const& _clusters) const
 {
-    string output = toUtf8();
+    string output = toUtf8(_clusters);
     while (!output.empty() && isspace(output.back()))
         output.pop_back();
     return output;
@@ -193,7 +402,13 @@ void Line::setText(std::string_view _u8string)
 
 void Line::resize(int _size)
 {
-    if (_size >= 0)
+    if (columns_ != 0)
+    {
+        // Compressed and trimmed lines can only grow, which merely appends fill cells.
+        assert(_size >= columns_);
+        columns_ = _size;
+    }
+    else if (_size >= 0)
         buffer_.resize(static_cast<int>(_size));
 }
 
@@ -246,6 +461,161 @@ Line::Buffer Line::reflow(int _newColumnCount)
     }
     return {};
 }
+
+Line::Line(int _numCols, CompressedBuffer&& _compressed, Flags _flags) :
+    flags_{ static_cast<unsigned>(_flags) },
+    columns_{ _numCols },
+    compressed_{ move(_compressed) }
+{
+}
+
+bool Line::containsImages() const noexcept
+{
+#if defined(LIBTERMINAL_IMAGES)
+    return !compressed() && std::any_of(buffer_.begin(), buffer_.end(),
+                                        [](Cell const& _cell) { return _cell.imageId() != 0; });
+#else
+    return false;
+#endif
+}
+
+Line::Buffer Line::compress(GraphemeClusterStore const& _clusters, CompressedBuffer& _scratch)
+{
+    assert(!compressed());
+    assert(!containsImages());
+
+    // Trailing cells that equal the last (blank) cell are restored from it upon decompression.
+    auto const columnCount = static_cast<size_t>(size());
+    auto const fill = isFillable(at(columnCount - 1)) ? at(columnCount - 1) : Cell{};
+    auto cellCount = columnCount;
+    while (cellCount != 0 && isFill(at(cellCount - 1), fill))
+        --cellCount;
+
+    _scratch.clear();
+    writeVarint(_scratch, static_cast<uint32_t>(cellCount));
+    writeVarint(_scratch, static_cast<uint32_t>(fill.attributesId()));
+#if defined(LIBTERMINAL_HYPERLINKS)
+    writeVarint(_scratch, static_cast<uint32_t>(fill.hyperlink()));
+#endif
+    writeRuns(_scratch, cellCount, [&](size_t i) { return buffer_[i].attributesId(); });
+#if defined(LIBTERMINAL_HYPERLINKS)
+    writeRuns(_scratch, cellCount, [&](size_t i) { return buffer_[i].hyperlink(); });
+#endif
+
+    for (Cell const& cell : crispy::range(buffer_.cbegin(), next(buffer_.cbegin(), cellCount)))
+    {
+        auto const naturalWidth = cell.codepointCount() ? Cell{cell.codepoint(), 0}.width() : 1;
+        if (cell.width() != naturalWidth)
+        {
+            _scratch.push_back(WidthTag);
+            _scratch.push_back(static_cast<uint8_t>(cell.width()));
+        }
+
+        if (cell.codepointCount() == 0)
+            _scratch.push_back(EmptyCellTag);
+        else if (cell.codepointCount() == 1 && cell.codepoint() >= 0x20)
+            writeUtf8(_scratch, cell.codepoint());
+        else
+        {
+            _scratch.push_back(ClusterCellTag);
+            _scratch.push_back(static_cast<uint8_t>(cell.codepointCount()));
+            for (char32_t const codepoint : cell.codepoints(_clusters))
+                writeUtf8(_scratch, codepoint);
+        }
+    }
+
+    columns_ = static_cast<int>(columnCount);
+    compressed_.assign(_scratch.begin(), _scratch.end());
+    return move(buffer_);
+}
+
+void Line::decompress(GraphemeClusterStore& _clusters, Buffer&& _storage)
+{
+    assert(compressed());
+
+    buffer_ = decodeCells(compressed_.data(), columns_, _clusters, move(_storage));
+    CompressedBuffer().swap(compressed_);
+    columns_ = 0;
+}
+
+Line::Buffer Line::decompressedCells(GraphemeClusterStore& _clusters, Buffer&& _storage) const
+{
+    assert(compressed());
+
+    return decodeCells(compressed_.data(), columns_, _clusters, move(_storage));
+}
+
+void Line::discardCompressed(Buffer&& _storage)
+{
+    assert(compressed());
+
+    buffer_ = move(_storage);
+    buffer_.assign(static_cast<size_t>(columns_), Cell{});
+    CompressedBuffer().swap(compressed_);
+    columns_ = 0;
+}
+
+void Line::trim()
+{
+    assert(!compressed() && !trimmed());
+
+    if (buffer_.empty() || !isFillable(buffer_.back()))
+        return;
+
+    // The last cell is kept as the fill cell.
+    auto const& fill = buffer_.back();
+    auto storedCount = buffer_.size();
+    while (storedCount > 1 && isFill(buffer_[storedCount - 2], fill))
+        --storedCount;
+
+    // Not worth it unless at least a quarter of the cells can be dropped.
+    if (storedCount == buffer_.size() || buffer_.size() - storedCount < buffer_.size() / 4)
+        return;
+
+    // Dropped in place, keeping the buffer's capacity, which is only released upon compression.
+    columns_ = static_cast<int>(buffer_.size());
+    buffer_.resize(storedCount);
+}
+
+void Line::untrim()
+{
+    assert(trimmed());
+
+    auto const fill = buffer_.back();
+    buffer_.resize(static_cast<size_t>(columns_), fill);
+    columns_ = 0;
+}
+
+void Line::markUsedAttributes(std::vector<bool>& _used) const
+{
+    if (!compressed())
+    {
+        for (Cell const& cell : buffer_)
+            _used[cell.attributesId()] = true;
+        return;
+    }
+
+    forEachAttributesRun(compressed_.data(), [&](GraphicsAttributesId _id) { _used[_id] = true; });
+}
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+void Line::markUsedHyperlinks(std::unordered_set<HyperlinkId>& _used) const
+{
+    auto const mark = [&](HyperlinkId _id) {
+        if (_id != 0)
+            _used.insert(_id);
+    };
+
+    if (!compressed())
+    {
+        for (Cell const& cell : buffer_)
+            mark(cell.hyperlink());
+        return;
+    }
+
+    forEachHyperlinkRun(compressed_.data(), mark);
+}
+#endif
 // }}}
 // {{{ Grid impl
 Grid::Grid(Size _screenSize, bool _reflowOnResize, optional<int> _maxHistoryLineCount) :
@@ -259,8 +629,10 @@ Grid::Grid(Size _screenSize, bool _reflowOnResize, optional<int> _maxHistoryLine
             Cell{},
             _reflowOnResize ? Line::Flags::Wrappable : Line::Flags::None
         )
-    )
+    ),
+    damage_(static_cast<size_t>(_screenSize.height))
 {
+    markPageDamaged();
 }
 
 /**
@@ -287,7 +659,7 @@ void addNewWrappedLines(Lines& _targetLines,
         auto to = next(begin(_logicalLineBuffer), _newColumnCount);
         auto const wrappedFlag = i == 0 && _initialNoWrap ? Line::Flags::None : Line::Flags::Wrapped;
         _targetLines.emplace_back(Line(from, to, _baseFlags | wrappedFlag));
-        logf(" - add line: '{}' ({})", _targetLines.back().toUtf8(), _targetLines.back().flags());
+        logf(" - add line: {} columns ({})", _targetLines.back().size(), _targetLines.back().flags());
         _logicalLineBuffer.erase(from, to);
         ++i;
     }
@@ -296,7 +668,7 @@ void addNewWrappedLines(Lines& _targetLines,
     {
         auto const wrappedFlag = i == 0 && _initialNoWrap ? Line::Flags::None : Line::Flags::Wrapped;
         _targetLines.emplace_back(Line(_newColumnCount, move(_logicalLineBuffer), _baseFlags | wrappedFlag));
-        logf(" - add line: '{}' ({})", _targetLines.back().toUtf8(), _targetLines.back().flags());
+        logf(" - add line: {} columns ({})", _targetLines.back().size(), _targetLines.back().flags());
     }
 }
 
@@ -307,35 +679,29 @@ void Grid::setMaxHistoryLineCount(optional<int> _maxHistoryLineCount)
 }
 
 // TODO: rename to include word Logical
-/**
- * Computes the relative line number for the bottom-most @p _n logical lines.
- */
-int Grid::computeRelativeLineNumberFromBottom(int _n) const noexcept
+int Grid::computeRelativeLineNumberFromBottom(int _n) const
 {
-    int logicalLineCount = 0;
-    int outputRelativePhysicalLine = screenSize_.height;
+    if (_n <= 0)
+        return screenSize_.height + 1;
 
-    auto i = lines_.rbegin();
-    while (i != lines_.rend())
-    {
-        if (!i->wrapped())
-            logicalLineCount++;
-        outputRelativePhysicalLine--;
-        ++i;
-        if (logicalLineCount == _n)
-            break;
-    }
+    auto const relativeLine = [this](int64_t _absoluteLine) {
+        return static_cast<int>(_absoluteLine) - historyLineCount() + 1;
+    };
 
-    // XXX If the top-most logical line is reached, we still need to traverse upwards until the
-    // beginning of the top-most logical line (the one that does not have the wrapped-flag set).
-    while (i != lines_.rend() && i->wrapped())
-    {
-        printf("further upwards: l %d, p %d\n", logicalLineCount, outputRelativePhysicalLine);
-        outputRelativePhysicalLine--;
-        ++i;
-    }
+    // Logical lines of the main page and the hot history area are counted line by line,
+    // as the main page is still subject to change.
+    auto remaining = _n;
+    for (int row = screenSize_.height; row > -attachedHistoryLineCount(); --row)
+        if (!lines_[static_cast<size_t>(attachedHistoryLineCount() + row - 1)].wrapped() && --remaining == 0)
+            return row;
+
+    // Every cold or spilled line is a logical line of its own, unless it continues the one above.
+    for (auto i = layout_.size(); i-- != 0; )
+        if (!(logicalLineFlags(i) & Line::Flags::Wrapped) && --remaining == 0)
+            return relativeLine(layout_[i].rowStart - historyRowBegin());
 
-    return outputRelativePhysicalLine;
+    // A top-most history line that is wrapped belongs to a logical line whose beginning has been evicted.
+    return relativeLine(0);
 }
 
 Coordinate Grid::resize(Size _newSize, Coordinate _currentCursorPos, bool _wrapPending)
@@ -346,7 +712,10 @@ Coordinate Grid::resize(Size _newSize, Coordinate _currentCursorPos, bool _wrapP
         // or create new ones until screenSize_.height == _newHeight.
 
         auto const extendCount = _newHeight - screenSize_.height;
-        auto const rowsToTakeFromSavedLines = min(extendCount, historyLineCount());
+
+        thawColdLines(extendCount);
+
+        auto const rowsToTakeFromSavedLines = min(extendCount, attachedHistoryLineCount());
         auto const fillLineCount = extendCount - rowsToTakeFromSavedLines;
         auto const wrappableFlag = lines_.back().wrappableFlag();
 
@@ -379,7 +748,7 @@ Coordinate Grid::resize(Size _newSize, Coordinate _currentCursorPos, bool _wrapP
         else
         {
             // Hard-cut below cursor by the number of lines to shrink.
-            lines_.resize(historyLineCount() + _newHeight);
+            lines_.resize(attachedHistoryLineCount() + _newHeight);
             screenSize_.height = _newHeight;
             return Coordinate{0, 0};
         }
@@ -397,62 +766,14 @@ Coordinate Grid::resize(Size _newSize, Coordinate _currentCursorPos, bool _wrapP
         }
         else
         {
-            // Grow columns by inverse shrink,
-            // i.e. the lines are traversed in reverse order.
-
-            auto const extendCount = _newColumnCount - screenSize_.width;
-            assert(extendCount > 0);
-
-            logf("Growing by {} cols", extendCount);
-
-            Lines grownLines;
-            Line::Buffer logicalLineBuffer; // Temporary state, representing wrapped columns from the line "below".
-            Line::Flags logicalLineFlags = Line::Flags::None;
-
-            [[maybe_unused]] auto i = 1;
-            for (Line& line : lines_)
-            {
-                logf("{:>2}: line: '{}' (wrapped: '{}') {}",
-                     i++,
-                     line.toUtf8(),
-                     Line(Line::Buffer(logicalLineBuffer), line.flags()).toUtf8(),
-                     line.wrapped() ? "WRAPPED" : "");
-                assert(line.size() >= screenSize_.width);
-
-                if (line.wrapped())
-                {
-                    crispy::copy(line.trim_blank_right(), back_inserter(logicalLineBuffer));
-                    logf(" - join: '{}'", Line(Line::Buffer(logicalLineBuffer), line.flags()).toUtf8());
-                }
-                else // line is not wrapped
-                {
-                    if (!logicalLineBuffer.empty())
-                    {
-                        addNewWrappedLines(grownLines, _newColumnCount, move(logicalLineBuffer), logicalLineFlags, true);
-                        logicalLineBuffer.clear();
-                    }
-
-                    crispy::copy(line, back_inserter(logicalLineBuffer));
-                    logicalLineFlags = line.wrappableFlag() | line.markedFlag();
-
-                    logf(" - start new logical line: '{}'", line.toUtf8());
-                }
-            }
-
-            if (!logicalLineBuffer.empty())
-            {
-                addNewWrappedLines(grownLines, _newColumnCount, move(logicalLineBuffer), logicalLineFlags, true);
-                logicalLineBuffer.clear();
-            }
-
-            lines_ = move(grownLines);
+            lines_ = reflowGrow(lines_, screenSize_.width, _newColumnCount);
             screenSize_.width = _newColumnCount;
 
             auto cy = 0;
-            if (historyLineCount() < 0)
+            if (attachedHistoryLineCount() < 0)
             {
-                cy = historyLineCount();
-                appendNewLines(-historyLineCount(), lines_.back()->back().attributes());
+                cy = attachedHistoryLineCount();
+                appendNewLines(-attachedHistoryLineCount(), lines_.back()->back().attributesId());
             }
 
             return _cursor + Coordinate{cy, _wrapPending ? 1 : 0};
@@ -472,77 +793,7 @@ Coordinate Grid::resize(Size _newSize, Coordinate _currentCursorPos, bool _wrapP
         }
         else
         {
-            // {{{ Shrinking progress
-            // -----------------------------------------------------------------------
-            //  (one-by-one)        | (from-5-to-2)
-            // -----------------------------------------------------------------------
-            // "ABCDE"              | "ABCDE"
-            // "abcde"              | "xy   "
-            // ->                   | "abcde"
-            // "ABCD"               | ->
-            // "E   "   Wrapped     | "AB"                  push "AB", wrap "CDE"
-            // "abcd"               | "CD"      Wrapped     push "CD", wrap "E"
-            // "e   "   Wrapped     | "E"       Wrapped     push "E",  inc line
-            // ->                   | "xy"      no-wrapped  push "xy", inc line
-            // "ABC"                | "ab"      no-wrapped  push "ab", wrap "cde"
-            // "DE "    Wrapped     | "cd"      Wrapped     push "cd", wrap "e"
-            // "abc"                | "e "      Wrapped     push "e",  inc line
-            // "de "    Wrapped
-            // ->
-            // "AB"
-            // "DE"     Wrapped
-            // "E "     Wrapped
-            // "ab"
-            // "cd"     Wrapped
-            // "e "     Wrapped
-            // }}}
-
-            Lines shrinkedLines;
-            Line::Buffer wrappedColumns;
-            Line::Flags previousFlags = lines_.front().inheritableFlags();
-
-            int i = 0;
-            for (Line& line : lines_)
-            {
-                logf("shrink line {}: \"{}\" wrapped: \"{}\"",
-                    i,
-                    line.toUtf8(),
-                    Line(Line::Buffer(wrappedColumns), previousFlags).toUtf8()
-                );
-                // do we have previous columns carried?
-                if (!wrappedColumns.empty())
-                {
-                    if (line.wrapped() && line.inheritableFlags() == previousFlags)
-                    {
-                        assert(previousFlags == line.inheritableFlags());
-                        // Prepend previously wrapped columns into current line.
-                        line.prepend(wrappedColumns);
-                    }
-                    else
-                    {
-                        // Insert NEW line(s) between previous and this line with previously wrapped columns.
-                        addNewWrappedLines(shrinkedLines, _newColumnCount, move(wrappedColumns), previousFlags, false);
-                        previousFlags = line.inheritableFlags();
-                    }
-                }
-                else
-                {
-                    previousFlags = line.inheritableFlags();
-                }
-
-                wrappedColumns = line.reflow(_newColumnCount);
-
-                auto const wrappedLine = Line(Line::Buffer(wrappedColumns), Line::Flags::None);
-                logf(" - ADD LINE: '{}' ({}) wrapped: \"{}\"", line.toUtf8(), line.flags(),
-                    Line(Line::Buffer(wrappedColumns), Line::Flags::None).toUtf8());
-
-                shrinkedLines.emplace_back(move(line));
-                assert(shrinkedLines.back().size() >= _newColumnCount);
-                i++;
-            }
-            addNewWrappedLines(shrinkedLines, _newColumnCount, move(wrappedColumns), previousFlags, false);
-
-            lines_ = move(shrinkedLines);
+            lines_ = reflowShrink(lines_, _newColumnCount);
             screenSize_.width = _newColumnCount;
 
             return _cursor; // TODO
@@ -551,6 +802,12 @@ Coordinate Grid::resize(Size _newSize, Coordinate _currentCursorPos, bool _wrapP
 
     Coordinate cursorPosition = _currentCursorPos;
 
+    // Changing the column count reflows the cells of every line. Only the main page and the
+    // hot history area are reflowed right away, whereas the cold and spilled lines keep their physical
+    // line layout for the previous column count until they are reflowed lazily (see reflowPendingLines()).
+    if (_newSize.width != screenSize_.width && reflowOnResize_)
+        expandAll();
+
     // grow/shrink columns
     switch (crispy::strongCompare(_newSize.width, screenSize_.width))
     {
@@ -577,43 +834,624 @@ Coordinate Grid::resize(Size _newSize, Coordinate _currentCursorPos, bool _wrapP
             break;
     }
 
+    updateHistoryLines();
+
+    damage_.resize(static_cast<size_t>(screenSize_.height));
+    markPageDamaged();
+
     return cursorPosition;
 }
 
-void Grid::appendNewLines(int _count, GraphicsAttributes _attr)
+Lines Grid::reflowGrow(Lines& _lines, int _columnCount, int _newColumnCount)
 {
-    auto const wrappableFlag = lines_.back().wrappableFlag();
+    // Grow columns by inverse shrink,
+    // i.e. the lines are traversed in reverse order.
+
+    assert(_newColumnCount > _columnCount);
+    logf("Growing by {} cols", _newColumnCount - _columnCount);
+
+    Lines grownLines;
+    Line::Buffer logicalLineBuffer; // Temporary state, representing wrapped columns from the line "below".
+    Line::Flags logicalLineFlags = Line::Flags::None;
+
+    [[maybe_unused]] auto i = 1;
+    for (Line& line : _lines)
+    {
+        logf("{:>2}: line: '{}' (wrapped: '{}') {}",
+             i++,
+             line.toUtf8(clusters_),
+             Line(Line::Buffer(logicalLineBuffer), line.flags()).toUtf8(clusters_),
+             line.wrapped() ? "WRAPPED" : "");
+        assert(line.size() >= _columnCount);
+
+        if (line.wrapped())
+        {
+            crispy::copy(line.trim_blank_right(), back_inserter(logicalLineBuffer));
+            logf(" - join: '{}'", Line(Line::Buffer(logicalLineBuffer), line.flags()).toUtf8(clusters_));
+        }
+        else // line is not wrapped
+        {
+            if (!logicalLineBuffer.empty())
+            {
+                addNewWrappedLines(grownLines, _newColumnCount, move(logicalLineBuffer), logicalLineFlags, true);
+                logicalLineBuffer.clear();
+            }
+
+            crispy::copy(line, back_inserter(logicalLineBuffer));
+            logicalLineFlags = line.wrappableFlag() | line.markedFlag();
+
+            logf(" - start new logical line: '{}'", line.toUtf8(clusters_));
+        }
+    }
+
+    if (!logicalLineBuffer.empty())
+    {
+        addNewWrappedLines(grownLines, _newColumnCount, move(logicalLineBuffer), logicalLineFlags, true);
+        logicalLineBuffer.clear();
+    }
+
+    return grownLines;
+}
+
+Lines Grid::reflowShrink(Lines& _lines, int _newColumnCount)
+{
+    // {{{ Shrinking progress
+    // -----------------------------------------------------------------------
+    //  (one-by-one)        | (from-5-to-2)
+    // -----------------------------------------------------------------------
+    // "ABCDE"              | "ABCDE"
+    // "abcde"              | "xy   "
+    // ->                   | "abcde"
+    // "ABCD"               | ->
+    // "E   "   Wrapped     | "AB"                  push "AB", wrap "CDE"
+    // "abcd"               | "CD"      Wrapped     push "CD", wrap "E"
+    // "e   "   Wrapped     | "E"       Wrapped     push "E",  inc line
+    // ->                   | "xy"      no-wrapped  push "xy", inc line
+    // "ABC"                | "ab"      no-wrapped  push "ab", wrap "cde"
+    // "DE "    Wrapped     | "cd"      Wrapped     push "cd", wrap "e"
+    // "abc"                | "e "      Wrapped     push "e",  inc line
+    // "de "    Wrapped
+    // ->
+    // "AB"
+    // "DE"     Wrapped
+    // "E "     Wrapped
+    // "ab"
+    // "cd"     Wrapped
+    // "e "     Wrapped
+    // }}}
+
+    Lines shrinkedLines;
+    Line::Buffer wrappedColumns;
+    Line::Flags previousFlags = _lines.front().inheritableFlags();
+
+    int i = 0;
+    for (Line& line : _lines)
+    {
+        logf("shrink line {}: \"{}\" wrapped: \"{}\"",
+            i,
+            line.toUtf8(clusters_),
+            Line(Line::Buffer(wrappedColumns), previousFlags).toUtf8(clusters_)
+        );
+        // do we have previous columns carried?
+        if (!wrappedColumns.empty())
+        {
+            if (line.wrapped() && line.inheritableFlags() == previousFlags)
+            {
+                assert(previousFlags == line.inheritableFlags());
+                // Prepend previously wrapped columns into current line.
+                line.prepend(wrappedColumns);
+            }
+            else
+            {
+                // Insert NEW line(s) between previous and this line with previously wrapped columns.
+                addNewWrappedLines(shrinkedLines, _newColumnCount, move(wrappedColumns), previousFlags, false);
+                previousFlags = line.inheritableFlags();
+            }
+        }
+        else
+        {
+            previousFlags = line.inheritableFlags();
+        }
+
+        wrappedColumns = line.reflow(_newColumnCount);
+
+        auto const wrappedLine = Line(Line::Buffer(wrappedColumns), Line::Flags::None);
+        logf(" - ADD LINE: '{}' ({}) wrapped: \"{}\"", line.toUtf8(clusters_), line.flags(),
+            Line(Line::Buffer(wrappedColumns), Line::Flags::None).toUtf8(clusters_));
+
+        shrinkedLines.emplace_back(move(line));
+        assert(shrinkedLines.back().size() >= _newColumnCount);
+        i++;
+    }
+    addNewWrappedLines(shrinkedLines, _newColumnCount, move(wrappedColumns), previousFlags, false);
+
+    return shrinkedLines;
+}
+
+int Grid::pendingReflowLineCount() const noexcept
+{
+    auto count = int64_t{0};
+    auto segmentStart = size_t{0};
+    for (auto const& segment : reflowSegments_)
+    {
+        auto const segmentEnd = segmentStart + static_cast<size_t>(segment.lineCount);
+        if (segment.columnCount != screenSize_.width)
+            count += layoutRowStart(segmentEnd) - layoutRowStart(segmentStart);
+        segmentStart = segmentEnd;
+    }
+    return static_cast<int>(count);
+}
+
+LineShift Grid::reflowPendingLines(int _maxLineCount)
+{
+    // Take whole logical lines from the bottom of the pending segment that is closest to the main page.
+    auto segmentEnd = layout_.size();
+    for (auto i = reflowSegments_.size(); i-- != 0; )
+    {
+        auto const segmentStart = segmentEnd - static_cast<size_t>(reflowSegments_[i].lineCount);
+        if (reflowSegments_[i].columnCount != screenSize_.width)
+        {
+            auto start = segmentEnd - 1;
+            while (start > segmentStart && layoutRowStart(segmentEnd) - layoutRowStart(start) < _maxLineCount)
+                --start;
+            return reflowLogicalLines(i, start, segmentEnd);
+        }
+        segmentEnd = segmentStart;
+    }
+
+    return {};
+}
 
-    if (historyLineCount() == maxHistoryLineCount().value_or(-1))
+optional<LineShift> Grid::reflowPendingLinesWithin(int _line, int _count)
+{
+    auto const firstLine = std::max(_line, 0);
+    auto const lastLine = std::min(_line + _count, spilledLineCount() + coldLineCount());
+    if (firstLine >= lastLine)
+        return nullopt;
+
+    auto const first = logicalLineAt(firstLine).first;
+    auto const last = logicalLineAt(lastLine - 1).first + 1;
+
+    // Take the bottom-most pending segment intersecting the range, and only the part of it within the range.
+    auto segmentEnd = layout_.size();
+    for (auto i = reflowSegments_.size(); i-- != 0 && segmentEnd > first; )
+    {
+        auto const segmentStart = segmentEnd - static_cast<size_t>(reflowSegments_[i].lineCount);
+        if (reflowSegments_[i].columnCount != screenSize_.width && segmentStart < last)
+            return reflowLogicalLines(i, std::max(segmentStart, first), std::min(segmentEnd, last));
+        segmentEnd = segmentStart;
+    }
+
+    return nullopt;
+}
+
+LineShift Grid::reflowLogicalLines(size_t _segment, size_t _start, size_t _end)
+{
+    auto const columnCount = reflowSegments_[_segment].columnCount;
+
+    // Only the prefix sums of the line counts change, the logical lines themselves stay as they are.
+    auto const end = layoutRowStart(_end);
+    auto rowStart = layout_[_start].rowStart;
+    for (LineLayout& layout : crispy::range(next(layout_.begin(), _start), next(layout_.begin(), _end)))
+    {
+        layout.rowStart = rowStart;
+        rowStart += rowCount(layout, screenSize_.width);
+    }
+
+    auto const delta = rowStart - end;
+    for (LineLayout& layout : crispy::range(next(layout_.begin(), _end), layout_.end()))
+        layout.rowStart += delta;
+    layoutRowEnd_ += delta;
+
+    // Split the segment around the reflowed lines, and join neighbouring segments of the same column count.
+    auto segmentStart = size_t{0};
+    for (size_t i = 0; i < _segment; ++i)
+        segmentStart += static_cast<size_t>(reflowSegments_[i].lineCount);
+    auto const aboveCount = static_cast<int>(_start - segmentStart);
+    auto const reflowedCount = static_cast<int>(_end - _start);
+    auto const belowCount = reflowSegments_[_segment].lineCount - aboveCount - reflowedCount;
+
+    auto segments = std::vector<ReflowSegment>{};
+    segments.reserve(reflowSegments_.size() + 2);
+    auto const appendSegment = [&](ReflowSegment _segment) {
+        if (_segment.lineCount == 0)
+            return;
+        if (!segments.empty() && segments.back().columnCount == _segment.columnCount)
+            segments.back().lineCount += _segment.lineCount;
+        else
+            segments.emplace_back(_segment);
+    };
+    for (size_t i = 0; i < reflowSegments_.size(); ++i)
+    {
+        if (i != _segment)
+        {
+            appendSegment(reflowSegments_[i]);
+            continue;
+        }
+        appendSegment(ReflowSegment{aboveCount, columnCount});
+        appendSegment(ReflowSegment{reflowedCount, screenSize_.width});
+        appendSegment(ReflowSegment{belowCount, columnCount});
+    }
+    reflowSegments_ = move(segments);
+
+    auto const shift = LineShift{
+        static_cast<int>(end - historyRowBegin()),
+        static_cast<int>(delta)
+    };
+
+    clampHistory();
+
+    return shift;
+}
+
+std::pair<size_t, int> Grid::logicalLineAt(int _line) const noexcept
+{
+    auto const rowNumber = historyRowBegin() + _line;
+    auto const i = std::upper_bound(layout_.begin(), layout_.end(), rowNumber,
+                                    [](int64_t _row, LineLayout const& _layout) { return _row < _layout.rowStart; });
+    auto const index = static_cast<size_t>(std::distance(layout_.begin(), i)) - 1;
+    return {index, static_cast<int>(rowNumber - layout_[index].rowStart)};
+}
+
+int Grid::layoutColumnCount(size_t _index) const noexcept
+{
+    auto segmentEnd = size_t{0};
+    for (auto const& segment : reflowSegments_)
+    {
+        segmentEnd += static_cast<size_t>(segment.lineCount);
+        if (_index < segmentEnd)
+            return segment.columnCount;
+    }
+    return screenSize_.width;
+}
+
+Line::Flags Grid::logicalLineFlags(size_t _index) const noexcept
+{
+    auto const spilledCount = static_cast<size_t>(spilledLogicalLineCount());
+    if (_index < spilledCount)
+        return static_cast<Line::Flags>(historyFile_->at(static_cast<int>(_index))[0]);
+
+    return coldLines_[_index - spilledCount].flags();
+}
+
+std::shared_ptr<Line const> Grid::logicalLineHandle(size_t _index) const
+{
+    auto const spilledCount = static_cast<size_t>(spilledLogicalLineCount());
+    if (_index < spilledCount)
+    {
+        auto const index = static_cast<int>(_index);
+        return decodedLine(~(spilledSerialOffset_ + index), [&]() { return decodeSpilledLine(index); });
+    }
+
+    Line const& line = coldLines_[_index - spilledCount];
+    if (!line.compressed())
+        return std::shared_ptr<Line const>(std::shared_ptr<Line const>{}, &line);
+
+    return decodedLine(coldSerialOffset_ + static_cast<int64_t>(_index - spilledCount), [&]() {
+        return Line(line.decompressedCells(clusters_, {}), line.flags());
+    });
+}
+
+Line Grid::physicalLine(LineLayout const& _layout, Line const& _line, int _row, int _columnCount)
+{
+    if (!_layout.reflowable)
+        return _line;
+
+    auto const size = static_cast<size_t>(_line.size());
+    auto const from = min(static_cast<size_t>(_row) * static_cast<size_t>(_columnCount), size);
+    auto const to = min(from + static_cast<size_t>(_columnCount), size);
+
+    auto cells = Line::Buffer(next(_line.begin(), from), next(_line.begin(), to));
+    cells.resize(static_cast<size_t>(_columnCount));
+
+    auto const flags = _row == 0 ? _line.flags() : _line.wrappableFlag() | Line::Flags::Wrapped;
+    return Line(move(cells), flags);
+}
+
+int Grid::logicalLength(Line::Buffer const& _cells, int _rowCount, int _columnCount) noexcept
+{
+    // The logical line spans all of its physical lines, as wrapping may leave blank cells at their ends.
+    auto length = static_cast<int>(_cells.size());
+    while (length > 0 && is_blank(_cells[static_cast<size_t>(length - 1)]))
+        --length;
+    if (_rowCount > 1)
+        length = std::max(length, (_rowCount - 1) * _columnCount + 1);
+    return length;
+}
+
+void Grid::appendLayout(int _length, int _rowCount, bool _reflowable)
+{
+    auto const width = screenSize_.width;
+
+    layout_.emplace_back(LineLayout{layoutRowEnd_, _length, _reflowable});
+    assert(rowCount(layout_.back(), width) == _rowCount);
+    layoutRowEnd_ += _rowCount;
+
+    if (!reflowSegments_.empty() && reflowSegments_.back().columnCount == width)
+        ++reflowSegments_.back().lineCount;
+    else
+        reflowSegments_.emplace_back(ReflowSegment{1, width});
+}
+
+void Grid::eraseLayout(size_t _index)
+{
+    auto const rows = layoutRowStart(_index + 1) - layout_[_index].rowStart;
+    if (_index != 0)
+    {
+        for (LineLayout& layout : crispy::range(next(layout_.begin(), _index + 1), layout_.end()))
+            layout.rowStart -= rows;
+        layoutRowEnd_ -= rows;
+    }
+    layout_.erase(next(layout_.begin(), _index));
+
+    auto segmentEnd = size_t{0};
+    for (auto i = reflowSegments_.begin(); i != reflowSegments_.end(); ++i)
+    {
+        segmentEnd += static_cast<size_t>(i->lineCount);
+        if (_index >= segmentEnd)
+            continue;
+        if (--i->lineCount == 0)
+        {
+            // Join the neighbouring segments if they are laid out for the same column count.
+            i = reflowSegments_.erase(i);
+            if (i != reflowSegments_.begin() && i != reflowSegments_.end() && prev(i)->columnCount == i->columnCount)
+            {
+                prev(i)->lineCount += i->lineCount;
+                reflowSegments_.erase(i);
+            }
+        }
+        break;
+    }
+}
+
+void Grid::freezeHotLines()
+{
+    auto const capacity = HotHistoryPageCount * screenSize_.height;
+    auto const historyLines = attachedHistoryLineCount();
+    auto const width = screenSize_.width;
+
+    auto frozen = 0;
+    while (historyLines - frozen > capacity)
+    {
+        // Lines not laid out for the current column count, such as after resizing without reflow,
+        // are kept as they are, and so are the lines that are not to be reflowed at all.
+        Line const& head = lines_[static_cast<size_t>(frozen)];
+        auto const reflowable = reflowOnResize_ && head.wrappable() && head.size() == width;
+
+        auto end = frozen + 1;
+        if (reflowable)
+            while (end < static_cast<int>(lines_.size())
+                   && lines_[static_cast<size_t>(end)].wrapped()
+                   && lines_[static_cast<size_t>(end)].size() == width)
+                ++end;
+
+        if (end > historyLines)
+        {
+            // The logical line is still being written to on the main page.
+            if (historyLines - frozen < 2 * capacity)
+                break;
+            end = historyLines - capacity;
+        }
+
+        auto cells = Line::Buffer{};
+        if (end - frozen == 1)
+        {
+            expandLine(lines_[static_cast<size_t>(frozen)]);
+            cells = move(lines_[static_cast<size_t>(frozen)].buffer());
+        }
+        else
+        {
+            cells.reserve(static_cast<size_t>((end - frozen) * width));
+            for (Line& line : crispy::range(next(lines_.begin(), frozen), next(lines_.begin(), end)))
+            {
+                expandLine(line);
+                cells.insert(cells.end(), line.begin(), line.end());
+            }
+        }
+
+        auto const length = logicalLength(cells, end - frozen, width);
+        coldLines_.emplace_back(Line(move(cells), head.flags()));
+        compressLine(coldLines_.back());
+        appendLayout(length, end - frozen, reflowable);
+
+        frozen = end;
+    }
+
+    if (frozen != 0)
+        lines_.erase_front(static_cast<size_t>(frozen));
+}
+
+void Grid::thawColdLines(int _lineCount)
+{
+    auto const width = screenSize_.width;
+
+    auto thawedLines = std::deque<Line>{};
+    while (attachedHistoryLineCount() + static_cast<int>(thawedLines.size()) < _lineCount && !coldLines_.empty())
     {
-        // We've reached to history line count limit already.
-        // Rotate lines that would fall off down to the bottom again in a clean state.
-        // We do save quite some overhead due to avoiding unnecessary memory allocations.
-        for (int i = 0; i < _count; ++i)
+        auto const handle = logicalLineHandle(layout_.size() - 1);
+        LineLayout const& layout = layout_.back();
+        for (auto row = rowCount(layout, width); row-- != 0; )
         {
-            Line line = move(lines_.front());
-            lines_.pop_front();
-            line.reset(_attr);
-            lines_.emplace_back(move(line));
+            thawedLines.emplace_front(physicalLine(layout, *handle, row, width));
+            if (thawedLines.front().size() < width)
+                thawedLines.front().resize(width);
         }
+
+        layoutRowEnd_ = layout.rowStart;
+        if (--reflowSegments_.back().lineCount == 0)
+            reflowSegments_.pop_back();
+        layout_.pop_back();
+        coldLines_.pop_back();
+    }
+
+    if (thawedLines.empty())
         return;
+
+    // The serial numbers of the thawed lines are going to be reused.
+    invalidateDecodedLines();
+
+    Lines lines;
+    lines.reserve(thawedLines.size() + lines_.size());
+    move(thawedLines.begin(), thawedLines.end(), back_inserter(lines));
+    move(lines_.begin(), lines_.end(), back_inserter(lines));
+    lines_ = move(lines);
+}
+
+int Grid::evictColdLines(int _lineCount)
+{
+    auto evictedCount = 0;
+    while (!coldLines_.empty() && evictedCount < _lineCount)
+    {
+        // The logical line keeps its layout when moving to the history file, as it is stored as is.
+        auto const index = static_cast<size_t>(spilledLogicalLineCount());
+        evictedCount += static_cast<int>(layoutRowStart(index + 1) - layout_[index].rowStart);
+        if (!historyFile_ || !spillLine(coldLines_.front()))
+            eraseLayout(index);
+
+        coldLines_.pop_front();
+        ++coldSerialOffset_;
     }
 
+    return evictedCount;
+}
+
+int Grid::spillHotLines(int _count)
+{
+    assert(_count == 0 || coldLines_.empty());
+
+    auto const historyLines = attachedHistoryLineCount();
+    auto const width = screenSize_.width;
+    auto start = 0;
+    while (start < _count)
+    {
+        Line& head = lines_[static_cast<size_t>(start)];
+        auto const reflowable = reflowOnResize_ && head.wrappable() && head.size() == width;
+
+        auto end = start + 1;
+        if (reflowable)
+            while (end < historyLines
+                   && lines_[static_cast<size_t>(end)].wrapped()
+                   && lines_[static_cast<size_t>(end)].size() == width)
+                ++end;
+
+        if (end - start == 1)
+        {
+            // The line is spilled in place, as it is about to be recycled.
+            auto length = head.size();
+            if (reflowable)
+            {
+                expandLine(head);
+                length = logicalLength(head.buffer(), 1, width);
+            }
+            if (spillLine(head))
+                appendLayout(length, 1, reflowable);
+        }
+        else
+        {
+            auto cells = Line::Buffer{};
+            cells.reserve(static_cast<size_t>((end - start) * width));
+            for (Line& line : crispy::range(next(lines_.begin(), start), next(lines_.begin(), end)))
+            {
+                expandLine(line);
+                cells.insert(cells.end(), line.begin(), line.end());
+            }
+
+            auto const length = logicalLength(cells, end - start, width);
+            auto line = Line(move(cells), head.flags());
+            if (spillLine(line))
+                appendLayout(length, end - start, reflowable);
+        }
+
+        start = end;
+    }
+
+    return start;
+}
+
+void Grid::appendNewLines(int _count, GraphicsAttributesId _attr)
+{
+    auto const wrappableFlag = lines_.back().wrappableFlag();
+
     if (auto const n = min(_count, screenSize_.height); n > 0)
     {
+        // Lines that would fall off the history limit are rotated down to the bottom again
+        // and reset in place, which avoids any memory (de)allocation once the limit is reached.
+        // Cold lines are the oldest ones though, and thus are evicted first.
+        auto const overflowCount = maxHistoryLineCount_.has_value()
+            ? std::clamp(residentHistoryLineCount() + n - *maxHistoryLineCount_, 0, n)
+            : 0;
+        auto const recycleCount = std::max(0, overflowCount - evictColdLines(overflowCount));
+
+        // Lines spilled along with the recycled ones, completing their logical line, are dropped.
+        auto const spilledCount = historyFile_ ? spillHotLines(recycleCount) : recycleCount;
+
+        lines_.rotate_left(static_cast<size_t>(recycleCount));
+        lines_.erase_front(static_cast<size_t>(spilledCount - recycleCount));
+        for (Line& line : crispy::range(prev(lines_.end(), recycleCount), lines_.end()))
+        {
+            if (line.compressed())
+                line.discardCompressed(takeSpareBuffer());
+            else if (line.trimmed())
+                line.untrim();
+            line.reset(_attr, wrappableFlag);
+        }
+
         generate_n(
             back_inserter(lines_),
-            n,
+            n - recycleCount,
             [&]() { return Line(screenSize_.width, Cell{{}, _attr}, wrappableFlag); }
         );
         clampHistory();
+
+        // Trim the lines that just moved into the history.
+        auto const historyLines = attachedHistoryLineCount();
+        for (int i = std::max(0, historyLines - n); i < historyLines; ++i)
+            trimLine(lines_[static_cast<size_t>(i)]);
+
+        freezeHotLines();
+
+        // Compressed lines store their clusters by value, and lines dropped from history none at all.
+        if (clusters_.size() >= clusterCollectThreshold_)
+        {
+            collectClusters();
+            clusterCollectThreshold_ = std::max(clusterCollectThreshold_, 2 * clusters_.size());
+        }
     }
 }
 
+void Grid::collectClusters()
+{
+    auto used = std::vector<bool>(clusters_.capacity() + 1, false);
+    auto const markUsedClusters = [&](Line const& _line) {
+        if (_line.compressed())
+            return;
+        for (Cell const& cell : _line)
+            if (auto const id = cell.clusterId(); id != 0)
+                used[id] = true;
+    };
+    for_each(coldLines_.begin(), coldLines_.end(), markUsedClusters);
+    for_each(lines_.begin(), lines_.end(), markUsedClusters);
+    for (auto const& [serial, line] : decodedLines_)
+        markUsedClusters(*line);
+
+    clusters_.collect(used);
+}
+
 void Grid::clearHistory()
 {
-    if (historyLineCount())
-        lines_.erase(begin(lines_), next(begin(lines_), historyLineCount()));
+    if (historyFile_)
+    {
+        forgetSpilledLines(historyFile_->size());
+        historyFile_->clear();
+    }
+
+    coldLines_.clear();
+    layout_.clear();
+    reflowSegments_.clear();
+    invalidateDecodedLines();
+
+    if (attachedHistoryLineCount())
+        lines_.erase_front(static_cast<size_t>(attachedHistoryLineCount()));
 }
 
 void Grid::clampHistory()
@@ -621,15 +1459,16 @@ void Grid::clampHistory()
     if (!maxHistoryLineCount_.has_value())
         return;
 
-    auto const actual = historyLineCount();
+    auto const actual = residentHistoryLineCount();
     auto const maxHistoryLines = maxHistoryLineCount_.value();
     if (actual < maxHistoryLines)
         return;
 
     auto const diff = actual - maxHistoryLines;
+    auto const attached = attachedHistoryLineCount();
 
     // any line that moves into history is using the default Wrappable flag.
-    for (auto& line : lines(historyLineCount() - diff, historyLineCount()))
+    for (auto& line : crispy::range(next(lines_.begin(), std::max(0, attached - diff)), next(lines_.begin(), attached)))
     {
         auto const wrappable = true;
         // std::cout << fmt::format(
@@ -640,11 +1479,240 @@ void Grid::clampHistory()
         line.setFlag(Line::Flags::Wrappable, wrappable);
     }
 
-    lines_.erase(begin(lines_), next(begin(lines_), diff));
+    // Cold lines are the oldest ones.
+    auto const attachedEvictionCount = std::max(0, diff - evictColdLines(diff));
+
+    auto const evictionCount = historyFile_ ? spillHotLines(attachedEvictionCount) : attachedEvictionCount;
+
+    lines_.erase_front(static_cast<size_t>(evictionCount));
+}
+
+void Grid::compressLine(Line& _line)
+{
+    if (_line.compressed() || _line.containsImages())
+        return;
+
+    auto cells = _line.compress(clusters_, compressionScratch_);
+    if (cells.capacity() >= static_cast<size_t>(screenSize_.width) && spareBuffers_.size() < static_cast<size_t>(screenSize_.height))
+        spareBuffers_.emplace_back(move(cells));
+}
+
+void Grid::trimLine(Line& _line)
+{
+    if (_line.compressed() || _line.trimmed())
+        return;
+
+    _line.trim();
 }
 
-void Grid::scrollUp(int _n, GraphicsAttributes const& _defaultAttributes, Margin const& _margin)
+void Grid::expandLine(Line& _line)
 {
+    if (_line.compressed())
+        _line.decompress(clusters_, takeSpareBuffer());
+    else if (_line.trimmed())
+        _line.untrim();
+}
+
+void Grid::expandAll()
+{
+    for (Line& line : lines_)
+        expandLine(line);
+}
+
+void Grid::updateHistoryLines()
+{
+    freezeHotLines();
+
+    auto const historyLines = attachedHistoryLineCount();
+    for (int i = 0; i < static_cast<int>(lines_.size()); ++i)
+    {
+        Line& line = lines_[static_cast<size_t>(i)];
+        if (i < historyLines)
+            trimLine(line);
+        else
+            expandLine(line);
+    }
+}
+
+void Grid::setHistoryFile(std::unique_ptr<HistoryFile> _file)
+{
+    // The lines of the previous history file are dropped, along with their layout.
+    if (historyFile_)
+        forgetSpilledLines(historyFile_->size());
+
+    historyFile_ = move(_file);
+    assert(!historyFile_ || historyFile_->size() == 0);
+    invalidateDecodedLines();
+    spilledAttributeRefs_.clear();
+#if defined(LIBTERMINAL_HYPERLINKS)
+    spilledHyperlinkRefs_.clear();
+#endif
+}
+
+void Grid::markUsedAttributes(std::vector<bool>& _used) const
+{
+    for (Line const& line : coldLines_)
+        line.markUsedAttributes(_used);
+    for (Line const& line : lines_)
+        line.markUsedAttributes(_used);
+
+    for (size_t id = 0; id < spilledAttributeRefs_.size(); ++id)
+        if (spilledAttributeRefs_[id])
+            _used[id] = true;
+}
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+void Grid::markUsedHyperlinks(std::unordered_set<HyperlinkId>& _used) const
+{
+    for (Line const& line : coldLines_)
+        line.markUsedHyperlinks(_used);
+    for (Line const& line : lines_)
+        line.markUsedHyperlinks(_used);
+
+    for (auto const& [id, refs] : spilledHyperlinkRefs_)
+        _used.insert(id);
+}
+#endif
+
+bool Grid::spillLine(Line& _line)
+{
+    if (!_line.compressed())
+    {
+#if defined(LIBTERMINAL_IMAGES)
+        // Images are not persisted to the history file.
+        for (Cell& cell : _line)
+            if (cell.imageId())
+                cell.setCharacter(0);
+#endif
+        compressLine(_line);
+    }
+
+    compressionScratch_.clear();
+    compressionScratch_.push_back(static_cast<uint8_t>(_line.flags()));
+    writeVarint(compressionScratch_, static_cast<uint32_t>(_line.size()));
+    auto const headerSize = compressionScratch_.size();
+    compressionScratch_.insert(compressionScratch_.end(),
+                               _line.compressedBuffer().begin(),
+                               _line.compressedBuffer().end());
+
+    if (compressionScratch_.size() > historyFile_->quota())
+    {
+        debuglog(TerminalTag).write("Dropping history line of {} bytes, exceeding the history file quota of {} bytes.",
+                                    compressionScratch_.size(), historyFile_->quota());
+        return false;
+    }
+
+    forgetSpilledLines(historyFile_->evictionCount(compressionScratch_.size()));
+    historyFile_->append(compressionScratch_.data(), compressionScratch_.size());
+
+    forEachAttributesRun(compressionScratch_.data() + headerSize, [&](GraphicsAttributesId _id) {
+        if (_id >= spilledAttributeRefs_.size())
+            spilledAttributeRefs_.resize(_id + 1u, 0);
+        ++spilledAttributeRefs_[_id];
+    });
+#if defined(LIBTERMINAL_HYPERLINKS)
+    forEachHyperlinkRun(compressionScratch_.data() + headerSize, [&](HyperlinkId _id) {
+        if (_id != 0)
+            ++spilledHyperlinkRefs_[_id];
+    });
+#endif
+    return true;
+}
+
+Line Grid::decodeSpilledLine(int _index) const
+{
+    auto const record = historyFile_->at(_index);
+    auto const* in = record.begin();
+    auto const flags = static_cast<Line::Flags>(*in++);
+    auto const columns = static_cast<int>(readVarint(in));
+
+    return Line(decodeCells(in, columns, clusters_, {}), flags);
+}
+
+template <typename Decode>
+std::shared_ptr<Line const> Grid::decodedLine(int64_t _serial, Decode&& _decode) const
+{
+    auto const _guard = DecodeScope{decodeCheck_};
+
+    if (auto const i = decodedLineIndex_.find(_serial); i != decodedLineIndex_.end())
+    {
+        decodedLines_.splice(decodedLines_.end(), decodedLines_, i->second);
+        return i->second->second;
+    }
+
+    if (decodedLines_.size() == DecodedLineCacheSize)
+    {
+        decodedLineIndex_.erase(decodedLines_.front().first);
+        decodedLines_.pop_front();
+    }
+
+    decodedLines_.emplace_back(_serial, std::make_shared<Line const>(_decode()));
+    decodedLineIndex_.emplace(_serial, prev(decodedLines_.end()));
+    return decodedLines_.back().second;
+}
+
+std::shared_ptr<Line const> Grid::lineHandleAt(int _line) const
+{
+    assert(crispy::ascending(0, _line, historyLineCount() + screenSize_.height - 1));
+
+    if (_line < spilledLineCount() + coldLineCount())
+    {
+        auto const [index, row] = logicalLineAt(_line);
+        auto const line = logicalLineHandle(index);
+        return std::make_shared<Line const>(physicalLine(layout_[index], *line, row, layoutColumnCount(index)));
+    }
+
+    Line const& line = lines_[static_cast<size_t>(_line - spilledLineCount() - coldLineCount())];
+    return std::shared_ptr<Line const>(std::shared_ptr<Line const>{}, &line);
+}
+
+void Grid::invalidateDecodedLines() const noexcept
+{
+    decodedLines_.clear();
+    decodedLineIndex_.clear();
+}
+
+void Grid::forgetSpilledLines(int _count)
+{
+    if (_count == 0)
+        return;
+
+    spilledSerialOffset_ += _count;
+    for (int i = 0; i < _count; ++i)
+    {
+        layout_.pop_front();
+        if (--reflowSegments_.front().lineCount == 0)
+            reflowSegments_.erase(reflowSegments_.begin());
+
+        auto const* in = historyFile_->at(i).begin();
+        ++in; // flags
+        readVarint(in); // column count
+        forEachAttributesRun(in, [&](GraphicsAttributesId _id) { --spilledAttributeRefs_[_id]; });
+#if defined(LIBTERMINAL_HYPERLINKS)
+        forEachHyperlinkRun(in, [&](HyperlinkId _id) {
+            if (_id != 0)
+                if (auto const i = spilledHyperlinkRefs_.find(_id); --i->second == 0)
+                    spilledHyperlinkRefs_.erase(i);
+        });
+#endif
+    }
+}
+
+Line::Buffer Grid::takeSpareBuffer()
+{
+    if (spareBuffers_.empty())
+        return {};
+
+    auto cells = move(spareBuffers_.back());
+    spareBuffers_.pop_back();
+    return cells;
+}
+
+void Grid::scrollUp(int _n, GraphicsAttributesId _defaultAttributes, Margin const& _margin)
+{
+    if (_n > 0)
+        markDamaged(_margin.vertical.from, _margin.vertical.to, _margin.horizontal.from, _margin.horizontal.to);
+
     if (_margin.horizontal != Margin::Range{1, screenSize_.width})
     {
         // a full "inside" scroll-up
@@ -680,7 +1748,7 @@ void Grid::scrollUp(int _n, GraphicsAttributes const& _defaultAttributes, Margin
             );
         }
 #else
-        for_each(
+        std::for_each(
             topLine,
             bottomLine,
             [&](Line& line) {
@@ -714,7 +1782,7 @@ void Grid::scrollUp(int _n, GraphicsAttributes const& _defaultAttributes, Margin
             );
         }
 
-        for_each(
+        std::for_each(
             LIBTERMINAL_EXECUTION_COMMA(par)
             next(begin(mainPage()), _margin.vertical.to - n),
             next(begin(mainPage()), _margin.vertical.to),
@@ -725,8 +1793,11 @@ void Grid::scrollUp(int _n, GraphicsAttributes const& _defaultAttributes, Margin
     }
 }
 
-void Grid::scrollDown(int v_n, GraphicsAttributes const& _defaultAttributes, Margin const& _margin)
+void Grid::scrollDown(int v_n, GraphicsAttributesId _defaultAttributes, Margin const& _margin)
 {
+    if (v_n > 0)
+        markDamaged(_margin.vertical.from, _margin.vertical.to, _margin.horizontal.from, _margin.horizontal.to);
+
     auto const marginHeight = _margin.vertical.length();
     auto const n = min(v_n, marginHeight);
 
@@ -756,7 +1827,7 @@ void Grid::scrollDown(int v_n, GraphicsAttributes const& _defaultAttributes, Mar
                 next(begin(*targetLine), _margin.horizontal.from - 1)
             );
 
-            for_each(
+            std::for_each(
                 next(begin(mainPage()), _margin.vertical.from - 1),
                 next(begin(mainPage()), _margin.vertical.from - 1 + n),
                 [&](Line& line) {
@@ -771,7 +1842,7 @@ void Grid::scrollDown(int v_n, GraphicsAttributes const& _defaultAttributes, Mar
         else
         {
             // clear everything in margin
-            for_each(
+            std::for_each(
                 next(begin(mainPage()), _margin.vertical.from - 1),
                 next(begin(mainPage()), _margin.vertical.to),
                 [&](Line& line) {
@@ -792,7 +1863,7 @@ void Grid::scrollDown(int v_n, GraphicsAttributes const& _defaultAttributes, Mar
             end(mainPage())
         );
 
-        for_each(
+        std::for_each(
             begin(mainPage()),
             next(begin(mainPage()), n),
             [&](Line& line) {
@@ -813,7 +1884,7 @@ void Grid::scrollDown(int v_n, GraphicsAttributes const& _defaultAttributes, Mar
             next(begin(mainPage()), _margin.vertical.to)
         );
 
-        for_each(
+        std::for_each(
             next(begin(mainPage()), _margin.vertical.from - 1),
             next(begin(mainPage()), _margin.vertical.from - 1 + n),
             [&](Line& line) {
@@ -829,11 +1900,13 @@ void Grid::scrollDown(int v_n, GraphicsAttributes const& _defaultAttributes, Mar
 
 string Grid::renderTextLineAbsolute(int row) const
 {
+    auto const lineHandle = lineHandleAt(row);
+
     string line;
     line.reserve(screenSize_.width);
     for (int col = 1; col <= screenSize_.width; ++col)
-        if (auto const& cell = at({row - historyLineCount() + 1, col}); cell.codepointCount())
-            line += cell.toUtf8();
+        if (auto const cell = cellAt(*lineHandle, col); cell.codepointCount())
+            line += cell.toUtf8(clusters_);
         else
             line += " "; // fill character
 
@@ -842,17 +1915,40 @@ string Grid::renderTextLineAbsolute(int row) const
 
 string Grid::renderTextLine(int row) const
 {
-    string line;
-    line.reserve(screenSize_.width);
-    for (int col = 1; col <= screenSize_.width; ++col)
-        if (auto const& cell = at({row, col}); cell.codepointCount())
-            line += cell.toUtf8();
-        else
-            line += " "; // fill character
+    return renderTextLineAbsolute(toAbsoluteLine(row));
+}
 
-    return line;
+#if defined(LIBTERMINAL_IMAGES)
+Cell::ImageId Grid::insertImage(std::shared_ptr<RasterizedImage const> _image)
+{
+    if (images_.capacity() >= imageCollectThreshold_)
+    {
+        collectImages();
+        imageCollectThreshold_ = std::max(imageCollectThreshold_, 2 * images_.size());
+    }
+
+    return images_.insert(move(_image));
 }
 
+void Grid::collectImages()
+{
+    auto used = std::vector<bool>(images_.capacity() + 1, false);
+    auto const markUsedImages = [&](Line const& _line) {
+        if (_line.compressed()) // compressed lines never contain images
+            return;
+        for (Cell const& cell : _line)
+            if (auto const id = cell.imageId(); id != 0)
+                used[id] = true;
+    };
+    for_each(coldLines_.begin(), coldLines_.end(), markUsedImages);
+    for_each(lines_.begin(), lines_.end(), markUsedImages);
+
+    for (Cell::ImageId id = 1; id <= images_.capacity(); ++id)
+        if (!used[id] && images_.at(id))
+            images_.release(id);
+}
+#endif
+
 string Grid::renderAllText() const
 {
     string text;
@@ -15,7 +15,9 @@
 
 #include <terminal/Charset.h>
 #include <terminal/Coordinate.h>
+#include <terminal/CodepointProperties.h>
 #include <terminal/Color.h>
+#include <terminal/HistoryFile.h>
 #include <terminal/Hyperlink.h>
 #include <terminal/Image.h>
 
@@ -23,6 +25,7 @@
 #include <crispy/indexed.h>
 #include <crispy/point.h>
 #include <crispy/range.h>
+#include <crispy/ring.h>
 #include <crispy/size.h>
 #include <crispy/span.h>
 #include <crispy/times.h>
@@ -36,8 +39,11 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <cassert>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -47,6 +53,9 @@
 #include <stack>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace terminal {
@@ -196,54 +205,235 @@ constexpr bool operator!=(GraphicsAttributes const& a, GraphicsAttributes const&
 }
 // }}}
 
+// {{{ GraphicsAttributesPool
+/// Small integer handle to an interned GraphicsAttributes value, as stored in grid cells.
+///
+/// The Id 0 always refers to the default (empty) graphics attributes.
+using GraphicsAttributesId = uint16_t;
+
+/// Interned storage of all distinct graphics renditions referenced by grid cells.
+///
+/// Real world output only uses a handful of distinct SGR combinations, so cells only
+/// store a GraphicsAttributesId, which also turns attribute comparison into an integer compare.
+class GraphicsAttributesPool {
+  public:
+    static constexpr size_t MaxSize = std::numeric_limits<GraphicsAttributesId>::max() + size_t{1};
+
+    GraphicsAttributesPool()
+    {
+        attributes_.emplace_back();
+        ids_.emplace(GraphicsAttributes{}, GraphicsAttributesId{0});
+    }
+
+    /// Interns the given attributes.
+    ///
+    /// @returns the Id of the attributes or std::nullopt if the pool is exhausted.
+    std::optional<GraphicsAttributesId> tryIntern(GraphicsAttributes const& _attributes)
+    {
+        if (auto const i = ids_.find(_attributes); i != ids_.end())
+            return i->second;
+
+        GraphicsAttributesId id{};
+        if (!freeIds_.empty())
+        {
+            id = freeIds_.back();
+            freeIds_.pop_back();
+            attributes_[id] = _attributes;
+        }
+        else if (attributes_.size() < MaxSize)
+        {
+            id = static_cast<GraphicsAttributesId>(attributes_.size());
+            attributes_.emplace_back(_attributes);
+        }
+        else
+            return std::nullopt;
+
+        ids_.emplace(_attributes, id);
+        return id;
+    }
+
+    GraphicsAttributes const& at(GraphicsAttributesId _id) const noexcept
+    {
+        assert(_id < attributes_.size());
+        return attributes_[_id];
+    }
+
+    /// Releases all Ids (except the default one) for which @p _used returns false.
+    ///
+    /// @param _used vector of size() elements indicating whether or not an Id is still referenced.
+    void collect(std::vector<bool> const& _used)
+    {
+        for (size_t id = 1; id < attributes_.size(); ++id)
+        {
+            if (_used[id])
+                continue;
+
+            if (auto const i = ids_.find(attributes_[id]); i != ids_.end() && i->second == id)
+            {
+                ids_.erase(i);
+                freeIds_.push_back(static_cast<GraphicsAttributesId>(id));
+            }
+        }
+    }
+
+    /// @returns the number of Id slots, including released ones.
+    size_t size() const noexcept { return attributes_.size(); }
+
+  private:
+    struct Hash {
+        size_t operator()(Color _color) const noexcept
+        {
+            auto const value = _color.type == ColorType::RGB
+                ? (unsigned(_color.rgb.red) << 16) | (unsigned(_color.rgb.green) << 8) | _color.rgb.blue
+                : unsigned(_color.index);
+            return (static_cast<size_t>(_color.type) << 24) | value;
+        }
+
+        size_t operator()(GraphicsAttributes const& _attributes) const noexcept
+        {
+            auto h = static_cast<size_t>(_attributes.styles);
+            h = h * 31 + (*this)(_attributes.foregroundColor);
+            h = h * 31 + (*this)(_attributes.backgroundColor);
+            h = h * 31 + (*this)(_attributes.underlineColor);
+            return h;
+        }
+    };
+
+    std::vector<GraphicsAttributes> attributes_;
+    std::vector<GraphicsAttributesId> freeIds_;
+    std::unordered_map<GraphicsAttributes, GraphicsAttributesId, Hash> ids_;
+};
+// }}}
+
+// {{{ GraphemeClusterStore
+/// Interned storage for grapheme clusters that consist of more than one codepoint.
+///
+/// Cells only store the first codepoint inline and refer to the full cluster by its Id.
+/// Since clusters are interned, the store only grows with the number of distinct clusters,
+/// and Ids no longer referenced by any cell are released by collect().
+class GraphemeClusterStore {
+  public:
+    using Id = uint32_t; // 0 is reserved for "no cluster"
+
+    GraphemeClusterStore() = default;
+    GraphemeClusterStore(GraphemeClusterStore&&) = default;
+    GraphemeClusterStore& operator=(GraphemeClusterStore&&) = default;
+
+    // Not copyable, as the index refers to the stored clusters.
+    GraphemeClusterStore(GraphemeClusterStore const&) = delete;
+    GraphemeClusterStore& operator=(GraphemeClusterStore const&) = delete;
+
+    /// Interns the given cluster, which is only copied if it is not known yet.
+    Id intern(std::u32string_view _codepoints)
+    {
+        if (auto const i = ids_.find(_codepoints); i != ids_.end())
+            return i->second;
+
+        Id id{};
+        if (!freeIds_.empty())
+        {
+            id = freeIds_.back();
+            freeIds_.pop_back();
+            clusters_[id - 1].assign(_codepoints.begin(), _codepoints.end());
+        }
+        else
+        {
+            clusters_.emplace_back(_codepoints);
+            id = static_cast<Id>(clusters_.size());
+        }
+        ids_.emplace(clusters_[id - 1], id);
+        return id;
+    }
+
+    std::u32string_view at(Id _id) const noexcept
+    {
+        assert(0 < _id && _id <= clusters_.size());
+        return clusters_[_id - 1];
+    }
+
+    /// Releases all Ids for which @p _used is false.
+    ///
+    /// @param _used vector of capacity() + 1 elements indicating whether or not an Id is still referenced.
+    void collect(std::vector<bool> const& _used)
+    {
+        for (size_t id = 1; id <= clusters_.size(); ++id)
+        {
+            // Released slots hold no cluster, hence are not found in the index.
+            if (_used[id] || !ids_.erase(clusters_[id - 1]))
+                continue;
+
+            std::u32string().swap(clusters_[id - 1]);
+            freeIds_.push_back(static_cast<Id>(id));
+        }
+    }
+
+    /// @returns the number of interned clusters.
+    size_t size() const noexcept { return clusters_.size() - freeIds_.size(); }
+
+    /// @returns the number of Id slots, including released ones.
+    size_t capacity() const noexcept { return clusters_.size(); }
+
+  private:
+    std::deque<std::u32string> clusters_;            // by Id - 1, element addresses are stable
+    std::vector<Id> freeIds_;
+    std::unordered_map<std::u32string_view, Id> ids_; // refers to the strings in clusters_
+};
+// }}}
+
 // {{{ Cell
 /// Grid cell with character and graphics rendition information.
+///
+/// A Cell is trivially copyable and does not own any heap memory.
+/// The first codepoint is stored inline, whereas multi-codepoint grapheme clusters
+/// are referenced via the owning Grid's GraphemeClusterStore, images via the Grid's
+/// CellImageStore, and hyperlinks via the Screen's HyperlinkStorage.
 class Cell {
   public:
     static size_t constexpr MaxCodepoints = 9;
 
-    Cell(char32_t _codepoint, GraphicsAttributes _attrib) noexcept :
-        codepoints_{},
+    using ImageId = uint32_t; // 0 is reserved for "no image"
+
+    Cell(char32_t _codepoint, GraphicsAttributesId _attrib) noexcept :
+        codepoint_{0},
+        extraId_{0},
+        codepointCount_{0},
         width_{1},
         attributes_{_attrib}
     {
         // setCharacter(_codepoint);
         if (_codepoint)
         {
-            codepoints_.assign(1, _codepoint);
-            width_ = std::max(unicode::width(_codepoint), 1);
+            codepoint_ = _codepoint;
+            codepointCount_ = 1;
+            width_ = static_cast<uint8_t>(std::max(codepointWidth(_codepoint), 1));
         }
     }
 
     Cell() noexcept :
-        codepoints_{},
+        codepoint_{0},
+        extraId_{0},
+        codepointCount_{0},
         width_{1},
-        attributes_{}
+        attributes_{0}
     {}
 
-    void reset(GraphicsAttributes _attributes = {}) noexcept
+    void reset(GraphicsAttributesId _attributes = 0) noexcept
     {
         attributes_ = _attributes;
         width_ = 1;
 #if defined(LIBTERMINAL_HYPERLINKS)
-        hyperlink_ = nullptr;
-#endif
-        codepoints_.clear();
-#if defined(LIBTERMINAL_IMAGES)
-        imageFragment_.reset();
+        hyperlink_ = 0;
 #endif
+        codepoint_ = 0;
+        codepointCount_ = 0;
+        extraId_ = 0;
     }
 
 #if defined(LIBTERMINAL_HYPERLINKS)
-    void reset(GraphicsAttributes _attribs, HyperlinkRef const& _hyperlink) noexcept
+    void reset(GraphicsAttributesId _attribs, HyperlinkId _hyperlink) noexcept
     {
-        attributes_ = _attribs;
-        width_ = 1;
-        codepoints_.clear();
+        reset(_attribs);
         hyperlink_ = _hyperlink;
-#if defined(LIBTERMINAL_IMAGES)
-        imageFragment_.reset();
-#endif
     }
 #endif
 
@@ -252,81 +442,104 @@ class Cell {
     Cell& operator=(Cell const&) = default;
     Cell& operator=(Cell&&) noexcept = default;
 
-    std::u32string_view codepoints() const noexcept
-    {
-        return codepoints_;
-    }
+    /// @returns the first codepoint of this cell's grapheme cluster, or 0 if empty.
+    char32_t codepoint() const noexcept { return codepointCount_ ? codepoint_ : 0; }
 
-    char32_t codepoint(size_t i) const noexcept
+    /// @returns all codepoints of this cell, resolving multi-codepoint clusters via @p _clusters.
+    std::u32string_view codepoints(GraphemeClusterStore const& _clusters) const noexcept
     {
-#if !defined(NDEBUG)
-        return codepoints_.at(i);
-#else
-        return codepoints_[i];
-#endif
+        if (codepointCount_ > 1)
+            return _clusters.at(extraId_);
+        return std::u32string_view(&codepoint_, codepointCount_);
     }
 
-    int codepointCount() const noexcept { return codepoints_.size(); }
+    int codepointCount() const noexcept { return codepointCount_; }
 
-#if defined(LIBTERMINAL_IMAGES)
-    bool empty() const noexcept { return codepoints_.empty() && !imageFragment_; }
-#else
-    bool empty() const noexcept { return codepoints_.empty(); }
-#endif
+    /// @returns the interned cluster Id if this cell holds more than one codepoint, 0 otherwise.
+    GraphemeClusterStore::Id clusterId() const noexcept { return codepointCount_ > 1 ? extraId_ : 0; }
+
+    bool empty() const noexcept { return codepointCount_ == 0 && !imageId(); }
 
     constexpr int width() const noexcept { return width_; }
 
-    constexpr GraphicsAttributes attributes() const noexcept { return attributes_; }
+    /// @returns the Id of this cell's graphics rendition within the Screen's GraphicsAttributesPool.
+    constexpr GraphicsAttributesId attributesId() const noexcept { return attributes_; }
 
-#if defined(LIBTERMINAL_IMAGES)
-    std::optional<ImageFragment> const& imageFragment() const noexcept { return imageFragment_; }
+    /// @returns the image Id into the Grid's CellImageStore, or 0 if this cell holds no image fragment.
+    ImageId imageId() const noexcept { return codepointCount_ == 0 ? extraId_ : 0; }
+
+    /// @returns the 0-based grid offset of this cell's image fragment into the rasterized image.
+    Coordinate imageOffset() const noexcept
+    {
+        return Coordinate{static_cast<int>(codepoint_ >> 16), static_cast<int>(codepoint_ & 0xFFFF)};
+    }
 
-    void setImage(ImageFragment _imageFragment)
+#if defined(LIBTERMINAL_IMAGES)
+    void setImage(ImageId _imageId, Coordinate _offset) noexcept
     {
-        imageFragment_.emplace(std::move(_imageFragment));
+        assert(_imageId != 0);
+        codepoint_ = (static_cast<char32_t>(_offset.row) << 16) | (static_cast<char32_t>(_offset.column) & 0xFFFF);
+        codepointCount_ = 0;
+        extraId_ = _imageId;
         width_ = 1;
-        codepoints_.clear();
     }
 
 #if defined(LIBTERMINAL_HYPERLINKS)
-    void setImage(ImageFragment _imageFragment, HyperlinkRef _hyperlink)
+    void setImage(ImageId _imageId, Coordinate _offset, HyperlinkId _hyperlink) noexcept
     {
-        setImage(std::move(_imageFragment));
-        hyperlink_ = std::move(_hyperlink);
+        setImage(_imageId, _offset);
+        hyperlink_ = _hyperlink;
     }
 #endif
 #endif
 
     void setCharacter(char32_t _codepoint) noexcept
     {
-#if defined(LIBTERMINAL_IMAGES)
-        imageFragment_.reset();
-#endif
+        extraId_ = 0;
         if (_codepoint)
         {
-            codepoints_.assign(1, _codepoint);
-            width_ = std::max(unicode::width(_codepoint), 1);
+            codepoint_ = _codepoint;
+            codepointCount_ = 1;
+            width_ = static_cast<uint8_t>(std::max(codepointWidth(_codepoint), 1));
         }
         else
         {
-            codepoints_.clear();
+            codepoint_ = 0;
+            codepointCount_ = 0;
             width_ = 1;
         }
     }
 
+    /// Sets a single codepoint that is known to be one cell wide, such as any printable US-ASCII character.
+    void setNarrowCharacter(char32_t _codepoint) noexcept
+    {
+        extraId_ = 0;
+        codepoint_ = _codepoint;
+        codepointCount_ = 1;
+        width_ = 1;
+    }
+
     void setWidth(int _width) noexcept
     {
-        width_ = _width;
+        width_ = static_cast<uint8_t>(_width);
     }
 
-    int appendCharacter(char32_t _codepoint) noexcept
+    int appendCharacter(char32_t _codepoint, GraphemeClusterStore& _clusters)
     {
-#if defined(LIBTERMINAL_IMAGES)
-        imageFragment_.reset();
-#endif
-        if (codepoints_.size() < MaxCodepoints)
+        if (codepointCount_ == 0)
         {
-            codepoints_.push_back(_codepoint);
+            setCharacter(_codepoint);
+            return 0;
+        }
+
+        if (codepointCount_ < MaxCodepoints)
+        {
+            auto cluster = std::array<char32_t, MaxCodepoints>{};
+            auto const current = codepoints(_clusters);
+            std::copy(current.begin(), current.end(), cluster.begin());
+            cluster[current.size()] = _codepoint;
+            extraId_ = _clusters.intern(std::u32string_view(cluster.data(), current.size() + 1));
+            codepointCount_++;
 
             constexpr bool AllowWidthChange = false; // TODO: make configurable
 
@@ -338,67 +551,112 @@ class Cell {
                     case 0xFE0F:
                         return 2;
                     default:
-                        return unicode::width(_codepoint);
+                        return codepointWidth(_codepoint);
                 }
             }();
 
             if (width != width_ && AllowWidthChange)
             {
                 int const diff = width - width_;
-                width_ = width;
+                width_ = static_cast<uint8_t>(width);
                 return diff;
             }
         }
         return 0;
     }
 
-    void setAttributes(GraphicsAttributes _attributes) noexcept
+    void setAttributes(GraphicsAttributesId _attributes) noexcept
     {
         attributes_ = _attributes;
     }
 
-    std::string toUtf8() const;
+    std::string toUtf8(GraphemeClusterStore const& _clusters) const;
 
 #if defined(LIBTERMINAL_HYPERLINKS)
-    HyperlinkRef hyperlink() const noexcept { return hyperlink_; }
-    void setHyperlink(HyperlinkRef const& _hyperlink) { hyperlink_ = _hyperlink; }
+    HyperlinkId hyperlink() const noexcept { return hyperlink_; }
+    void setHyperlink(HyperlinkId _hyperlink) noexcept { hyperlink_ = _hyperlink; }
 #endif
 
   private:
-    /// Unicode codepoint to be displayed.
-    std::u32string codepoints_;
+    /// First Unicode codepoint to be displayed, or the packed image fragment offset for image cells.
+    char32_t codepoint_;
+
+    /// Cluster Id (if codepointCount_ > 1) or image Id (if codepointCount_ == 0), 0 otherwise.
+    uint32_t extraId_;
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+    HyperlinkId hyperlink_ = 0;
+#endif
+
+    /// Number of codepoints this cell's grapheme cluster is made of.
+    uint8_t codepointCount_;
 
     /// number of cells this cell spans. Usually this is 1, but it may be also 0 or >= 2.
     uint8_t width_;
 
     /// Graphics renditions, such as foreground/background color or other grpahics attributes.
-    GraphicsAttributes attributes_;
+    GraphicsAttributesId attributes_;
+};
 
+static_assert(std::is_trivially_copyable_v<Cell>);
 #if defined(LIBTERMINAL_HYPERLINKS)
-    HyperlinkRef hyperlink_ = nullptr;
-#endif
-
-    /// Image fragment to be rendered in this cell.
-#if defined(LIBTERMINAL_IMAGES)
-    std::optional<ImageFragment> imageFragment_;
+static_assert(sizeof(Cell) == 16);
 #endif
-};
 
 inline bool operator==(Cell const& a, Cell const& b) noexcept
 {
-    if (a.codepointCount() != b.codepointCount())
-        return false;
+    // Grapheme clusters are interned, so comparing the first codepoint and the cluster Id suffices.
+    return a.codepointCount() == b.codepointCount()
+        && a.codepoint() == b.codepoint()
+        && a.clusterId() == b.clusterId()
+        && a.attributesId() == b.attributesId();
+}
+// }}}
 
-    if (!(a.attributes() == b.attributes()))
-        return false;
+// {{{ CellImageStore
+#if defined(LIBTERMINAL_IMAGES)
+/// Maps the small integer image Ids stored in grid cells to their rasterized images.
+///
+/// Slots are released by Grid's garbage collection once no cell refers to them anymore.
+class CellImageStore {
+  public:
+    Cell::ImageId insert(std::shared_ptr<RasterizedImage const> _image)
+    {
+        if (!freeIds_.empty())
+        {
+            auto const id = freeIds_.back();
+            freeIds_.pop_back();
+            images_[id - 1] = std::move(_image);
+            return id;
+        }
 
-    for (auto const i : crispy::times(a.codepointCount()))
-        if (a.codepoint(i) != b.codepoint(i))
-            return false;
+        images_.emplace_back(std::move(_image));
+        return static_cast<Cell::ImageId>(images_.size());
+    }
 
-    return true;
-}
+    std::shared_ptr<RasterizedImage const> const& at(Cell::ImageId _id) const noexcept
+    {
+        assert(0 < _id && _id <= images_.size());
+        return images_[_id - 1];
+    }
+
+    void release(Cell::ImageId _id)
+    {
+        images_[_id - 1].reset();
+        freeIds_.push_back(_id);
+    }
+
+    /// @returns the number of slots in use.
+    size_t size() const noexcept { return images_.size() - freeIds_.size(); }
 
+    /// @returns the number of slots, including released ones.
+    size_t capacity() const noexcept { return images_.size(); }
+
+  private:
+    std::vector<std::shared_ptr<RasterizedImage const>> images_;
+    std::vector<Cell::ImageId> freeIds_;
+};
+#endif
 // }}}
 
 class Line { // {{{
@@ -411,6 +669,7 @@ class Line { // {{{
     };
 
     using Buffer = std::vector<Cell>;
+    using CompressedBuffer = std::vector<uint8_t>;
     using iterator = Buffer::iterator;
     using const_iterator = Buffer::const_iterator;
     using reverse_iterator = Buffer::reverse_iterator;
@@ -425,6 +684,7 @@ class Line { // {{{
     Line(iterator const& _begin, iterator const& _end, Flags _flags);
     Line(int _numCols, Buffer&& _init, Flags _flags);
     Line(int _numCols, std::string_view const& _s, Flags _flags);
+    Line(int _numCols, CompressedBuffer&& _compressed, Flags _flags);
 
     Buffer& buffer() noexcept { return buffer_; }
 
@@ -434,16 +694,87 @@ class Line { // {{{
     Line& operator=(Line const&) = default;
     Line& operator=(Line&&) = default;
 
-    void reset(GraphicsAttributes _attributes) noexcept
+    void reset(GraphicsAttributesId _attributes) noexcept
     {
+        assert(!compressed() && !trimmed());
         for (Cell& cell: buffer_)
             cell.reset(_attributes);
     }
 
+    void reset(GraphicsAttributesId _attributes, Flags _flags) noexcept
+    {
+        reset(_attributes);
+        flags_ = static_cast<unsigned>(_flags);
+    }
+
+    /// @returns true if the cells of this line are only available in their compressed form.
+    ///
+    /// The compressed form trims trailing default cells, run-length encodes the graphics
+    /// attributes and hyperlinks, and stores the text as UTF-8.
+    bool compressed() const noexcept { return !compressed_.empty(); }
+
+    /// @returns true if this line only holds its occupied columns plus a single fill cell,
+    ///          which stands for all the remaining (blank) columns up to size().
+    bool trimmed() const noexcept { return columns_ != 0 && compressed_.empty(); }
+
+    /// @returns the compressed form of this line's cells, which is empty if the line is not compressed.
+    CompressedBuffer const& compressedBuffer() const noexcept { return compressed_; }
+
+    /// @returns true if any cell of this line refers to an image fragment.
+    bool containsImages() const noexcept;
+
+    /// Encodes this line's cells into their compressed form.
+    ///
+    /// The line must not contain any image fragments.
+    ///
+    /// @param _clusters  storage to resolve multi-codepoint grapheme clusters from.
+    /// @param _scratch   reusable encoding buffer.
+    ///
+    /// @returns the now unused cell buffer, so that it can be reused by the caller.
+    [[nodiscard]] Buffer compress(GraphemeClusterStore const& _clusters, CompressedBuffer& _scratch);
+
+    /// Decodes this line's cells from their compressed form into @p _storage.
+    void decompress(GraphemeClusterStore& _clusters, Buffer&& _storage);
+
+    /// @returns this compressed line's cells, decoded into @p _storage, leaving this line as it is.
+    [[nodiscard]] Buffer decompressedCells(GraphemeClusterStore& _clusters, Buffer&& _storage) const;
+
+    /// Drops the compressed form of this line without decoding it, reusing @p _storage
+    /// for the line's (default constructed) cells.
+    void discardCompressed(Buffer&& _storage);
+
+    /// Drops the trailing blank cells that equal the last cell, if there is a considerable amount of them.
+    ///
+    /// The cells are dropped in place, so that neither trimming nor untrimming allocates.
+    void trim();
+
+    /// Restores all cells of a trimmed line.
+    void untrim();
+
+    /// Marks the graphics attributes Ids referenced by this line's cells in @p _used,
+    /// regardless of whether or not this line is compressed.
+    void markUsedAttributes(std::vector<bool>& _used) const;
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+    /// Adds the hyperlink Ids referenced by this line's cells to @p _used,
+    /// regardless of whether or not this line is compressed.
+    void markUsedHyperlinks(std::unordered_set<HyperlinkId>& _used) const;
+#endif
+
+    // The cell accessors below only cover the cells actually stored, hence they must not be used on
+    // compressed lines, and on trimmed lines only up to the stored cells (see at() for the others).
+
     Buffer* operator->() noexcept { return &buffer_; }
     Buffer const* operator->() const noexcept { return &buffer_; }
-    auto& operator[](std::size_t _index) { return buffer_[_index]; }
-    auto const& operator[](std::size_t _index) const { return buffer_[_index]; }
+    auto& operator[](std::size_t _index) { assert(_index < buffer_.size()); return buffer_[_index]; }
+    auto const& operator[](std::size_t _index) const { assert(_index < buffer_.size()); return buffer_[_index]; }
+
+    /// @returns the cell at the given 0-based column, including the fill cells of trimmed lines.
+    Cell const& at(std::size_t _index) const noexcept
+    {
+        assert(!compressed());
+        return _index < buffer_.size() ? buffer_[_index] : buffer_.back();
+    }
 
     void prepend(Buffer const&);
     void append(Buffer const&);
@@ -458,23 +789,21 @@ class Line { // {{{
 
     crispy::range<const_iterator> trim_blank_right() const;
 
-    int size() const noexcept { return static_cast<int>(buffer_.size()); }
+    int size() const noexcept { return columns_ != 0 ? columns_ : static_cast<int>(buffer_.size()); }
 
     bool blank() const noexcept;
 
-    // TODO (trimmed version of size()): int maxOccupiedColumns() const noexcept { return size(); }
-
     void resize(int _size);
     [[nodiscard]] Buffer reflow(int _column);
 
-    iterator begin() { return buffer_.begin(); }
-    iterator end() { return buffer_.end(); }
-    const_iterator begin() const { return buffer_.begin(); }
-    const_iterator end() const { return buffer_.end(); }
-    reverse_iterator rbegin() { return buffer_.rbegin(); }
-    reverse_iterator rend() { return buffer_.rend(); }
-    const_iterator cbegin() const { return buffer_.cbegin(); }
-    const_iterator cend() const { return buffer_.cend(); }
+    iterator begin() { assert(!compressed()); return buffer_.begin(); }
+    iterator end() { assert(!compressed()); return buffer_.end(); }
+    const_iterator begin() const { assert(!compressed()); return buffer_.begin(); }
+    const_iterator end() const { assert(!compressed()); return buffer_.end(); }
+    reverse_iterator rbegin() { assert(!compressed()); return buffer_.rbegin(); }
+    reverse_iterator rend() { assert(!compressed()); return buffer_.rend(); }
+    const_iterator cbegin() const { assert(!compressed()); return buffer_.cbegin(); }
+    const_iterator cend() const { assert(!compressed()); return buffer_.cend(); }
 
     bool marked() const noexcept { return isFlagEnabled(Flags::Marked); }
     void setMarked(bool _enable) { setFlag(Flags::Marked, _enable); }
@@ -488,8 +817,8 @@ class Line { // {{{
     Flags wrappableFlag() const noexcept { return wrappable() ? Line::Flags::Wrappable : Line::Flags::None; }
     Flags markedFlag() const noexcept { return marked() ? Line::Flags::Marked : Line::Flags::None; }
 
-    std::string toUtf8() const;
-    std::string toUtf8Trimmed() const;
+    std::string toUtf8(GraphemeClusterStore const& _clusters) const;
+    std::string toUtf8Trimmed(GraphemeClusterStore const& _clusters) const;
 
     void setText(std::string_view _u8string);
 
@@ -515,6 +844,8 @@ class Line { // {{{
   private:
     Buffer buffer_;
     unsigned flags_;
+    int columns_ = 0; // column count of compressed or trimmed lines, 0 otherwise
+    CompressedBuffer compressed_;
 };
 
 constexpr Line::Flags operator|(Line::Flags a, Line::Flags b) noexcept
@@ -528,7 +859,7 @@ constexpr bool operator&(Line::Flags a, Line::Flags b) noexcept
 }
 // }}}
 
-using Lines = std::deque<Line>;
+using Lines = crispy::ring<Line>;
 using ColumnIterator = Line::iterator;
 using LineIterator = Lines::iterator;
 
@@ -539,6 +870,27 @@ inline auto end(Line const& _line) { return _line.cend(); }
 inline Line::const_iterator cbegin(Line const& _line) { return _line.cbegin(); }
 inline Line::const_iterator cend(Line const& _line) { return _line.cend(); }
 
+/// Describes a change of absolute line numbers, as caused by reflowing scrollback lines:
+/// all lines starting at absolute line @c line (before the change) moved by @c delta lines.
+struct LineShift {
+    int line = 0;
+    int delta = 0;
+};
+
+/// Span of modified columns (1-based, inclusive) of a main page line since the damage was last cleared.
+struct LineDamage {
+    int from = std::numeric_limits<int>::max();
+    int to = 0;
+
+    constexpr bool empty() const noexcept { return to < from; }
+
+    constexpr void add(int _from, int _to) noexcept
+    {
+        from = std::min(from, _from);
+        to = std::max(to, _to);
+    }
+};
+
 /**
  * Manages the screen grid buffer (main screen + scrollback history).
  *
@@ -564,6 +916,21 @@ inline Line::const_iterator cend(Line const& _line) { return _line.cend(); }
  *       ^                          ^
  *       1                          screenSize.columns
  * </pre>
+ *
+ * <h3>Scrollback storage</h3>
+ *
+ * The most recent HotHistoryPageCount pages of scrollback are kept as uncompressed physical lines
+ * in the main line buffer, along with the main page. Older (cold) scrollback, as well as the
+ * scrollback moved to the history file, is stored as whole logical lines, compressed, and their
+ * physical line layout for a given column count is merely computed: a prefix sum of the physical
+ * line counts maps absolute line numbers to logical lines, whose cells are only decoded when accessed.
+ * Hence reflowing such scrollback only recomputes line counts, and is done lazily (see pendingReflowLineCount()).
+ *
+ * <h3>Thread safety</h3>
+ *
+ * A Grid is not thread-safe, not even its const member functions, as these decode compressed
+ * or spilled history lines on access. The owner must serialize all access to it, which
+ * the Terminal does via its lock. Debug builds assert on history lines being decoded concurrently.
  */
 class Grid {
   public:
@@ -590,18 +957,84 @@ class Grid {
     bool reflowOnResize() const noexcept { return reflowOnResize_; }
     void setReflowOnResize(bool _enabled) { reflowOnResize_ = _enabled; }
 
-    int historyLineCount() const noexcept { return static_cast<int>(lines_.size()) - screenSize_.height; }
+    /// @returns the total number of scrollback lines, including the ones moved to the history file.
+    int historyLineCount() const noexcept { return spilledLineCount() + residentHistoryLineCount(); }
+
+    /// @returns the number of scrollback lines that are held in memory.
+    int residentHistoryLineCount() const noexcept { return coldLineCount() + attachedHistoryLineCount(); }
+
+    /// @returns the number of cold or spilled scrollback lines that are still laid out for a previous column count.
+    int pendingReflowLineCount() const noexcept;
+
+    /// Reflows up to about @p _maxLineCount of the lines that are pending reflow,
+    /// starting with the ones closest to the main page.
+    ///
+    /// As cold and spilled scrollback is stored as logical lines, this only recomputes their physical line counts.
+    ///
+    /// @returns how the absolute line numbers of the lines below the reflowed ones changed.
+    LineShift reflowPendingLines(int _maxLineCount);
+
+    /// Reflows the bottom-most run of lines pending reflow among the absolute lines
+    /// [@p _line, @p _line + @p _count), extended to whole logical lines.
+    ///
+    /// Lines pending reflow above and below are left as they are, so that the history
+    /// in view can be reflowed without reflowing all of the history below it.
+    /// Invoke repeatedly until it returns std::nullopt to reflow all lines of the range.
+    ///
+    /// @returns how the absolute line numbers of the lines below the reflowed ones changed,
+    ///          or std::nullopt if no line of the range is pending reflow.
+    std::optional<LineShift> reflowPendingLinesWithin(int _line, int _count);
+
+    /// Moves scrollback lines that exceed the history limit into @p _file rather than deleting them.
+    ///
+    /// The history file is bounded by its own quota, whereas maxHistoryLineCount() then only
+    /// limits the number of scrollback lines held in memory.
+    /// Passing nullptr deletes all lines that have been moved to the current history file.
+    void setHistoryFile(std::unique_ptr<HistoryFile> _file);
+    HistoryFile const* historyFile() const noexcept { return historyFile_.get(); }
+
+    /// @returns the number of (oldest) scrollback lines that have been moved to the history file.
+    int spilledLineCount() const noexcept
+    {
+        return static_cast<int>(layoutRowStart(static_cast<size_t>(spilledLogicalLineCount())) - historyRowBegin());
+    }
+
+    /// Marks the graphics attributes Ids referenced by any line of this grid in @p _used.
+    void markUsedAttributes(std::vector<bool>& _used) const;
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+    /// Adds the hyperlink Ids referenced by any line of this grid, including the history file, to @p _used.
+    void markUsedHyperlinks(std::unordered_set<HyperlinkId>& _used) const;
+#endif
 
     /// Renders the full screen by passing every grid cell to the callback.
     template <typename RendererT>
     void render(RendererT && _render, std::optional<int> _scrollOffset = std::nullopt) const;
 
-    Line& absoluteLineAt(int _line) noexcept;
-    Line const& absoluteLineAt(int _line) const noexcept;
+    /// Renders the screen line @p _row by passing each of its cells to the callback.
+    template <typename RendererT>
+    void renderLine(RendererT && _render, int _row, std::optional<int> _scrollOffset = std::nullopt) const;
+
+    /// @returns reference to Line at given absolute offset @p _line, which must be a line
+    ///          of the main page or the hot history area (see coldLineCount()).
+    ///
+    /// Trimmed lines are restored to all of their cells before being handed out.
+    Line& absoluteLineAt(int _line);
+
+    /// @returns a copy of the Line at given absolute offset @p _line.
+    ///
+    /// Lines of the cold history area and of the history file are cut out of their logical line,
+    /// which is decoded on access (see DecodedLineCacheSize).
+    Line absoluteLineAt(int _line) const;
+
+    /// @returns the flags of the Line at given absolute offset @p _line without decompressing it.
+    Line::Flags absoluteLineFlags(int _line) const noexcept;
 
-    /// @returns reference to Line at given relative offset @p _line.
-    Line& lineAt(int _line) noexcept;
-    Line const& lineAt(int _line) const noexcept;
+    /// @returns reference to Line at given relative offset @p _line (see absoluteLineAt()).
+    Line& lineAt(int _line);
+
+    /// @returns a copy of the Line at given relative offset @p _line (see absoluteLineAt()).
+    Line lineAt(int _line) const;
 
     /// Converts a relative line number into an absolute line number.
     int toAbsoluteLine(int _relativeLine) const noexcept;
@@ -609,14 +1042,19 @@ class Grid {
     /// Converts an absolute line number into a relative line number.
     int toRelativeLine(int _absoluteLine) const noexcept;
 
-    int computeRelativeLineNumberFromBottom(int _n) const noexcept;
+    /// @returns the relative line number of the first physical line of the bottom-most @p _n logical lines.
+    int computeRelativeLineNumberFromBottom(int _n) const;
 
-    /// Gets a reference to the cell relative to screen origin (top left, 1:1).
-    Cell& at(Coordinate const& _coord) noexcept;
+    /// Gets a reference to the cell relative to screen origin (top left, 1:1),
+    /// which must be on a line of the main page or the hot history area (see absoluteLineAt()).
+    Cell& at(Coordinate const& _coord);
 
-    /// Gets a reference to the cell relative to screen origin (top left, 1:1).
-    Cell const& at(Coordinate const& _coord) const noexcept;
+    /// @returns the cell relative to screen origin (top left, 1:1).
+    ///
+    /// Columns beyond the line's size, as for lines pending reflow, yield a blank cell.
+    Cell at(Coordinate const& _coord) const;
 
+    /// @returns the given range of lines, which must be lines of the main page or the hot history area.
     crispy::range<Lines::const_iterator> lines(int _start, int _count) const;
     crispy::range<Lines::iterator> lines(int _start, int _count);
 
@@ -626,24 +1064,71 @@ class Grid {
     crispy::range<Lines::const_iterator> mainPage() const;
     crispy::range<Lines::iterator> mainPage();
 
+    /// @returns the scrollback lines of the hot history area, i.e. the ones held in the main line buffer.
     crispy::range<Lines::const_iterator> scrollbackLines() const;
 
+    /// Number of screen pages of the most recent scrollback history that is kept as uncompressed physical lines.
+    ///
+    /// Any history line above that is stored as part of a compressed logical line (see Line::compress()).
+    static constexpr int HotHistoryPageCount = 3;
+
+    /// Maximum number of decoded cold logical lines and spilled history lines kept in memory.
+    ///
+    /// Decoding another line evicts the least recently accessed one.
+    static constexpr size_t DecodedLineCacheSize = 128;
+
+    /// @returns the number of in-memory scrollback lines above the hot history area,
+    ///          which are stored as compressed logical lines.
+    int coldLineCount() const noexcept
+    {
+        return static_cast<int>(layoutRowEnd_ - layoutRowStart(static_cast<size_t>(spilledLogicalLineCount())));
+    }
+
     /// Completely deletes all scrollback lines.
     void clearHistory();
 
     /// Scrolls up by @p _n lines within the given margin.
     ///
     /// @param _n number of lines to scroll up within the given margin.
-    /// @param _defaultAttributes SGR attributes the newly created grid cells will be initialized with.
+    /// @param _defaultAttributes Id of the SGR attributes the newly created grid cells will be initialized with.
     /// @param _margin the margin coordinates to perform the scrolling action into.
-    void scrollUp(int _n, GraphicsAttributes const& _defaultAttributes, Margin const& _margin);
+    void scrollUp(int _n, GraphicsAttributesId _defaultAttributes, Margin const& _margin);
 
     /// Scrolls down by @p _n lines within the given margin.
     ///
     /// @param _n number of lines to scroll down within the given margin.
-    /// @param _defaultAttributes SGR attributes the newly created grid cells will be initialized with.
+    /// @param _defaultAttributes Id of the SGR attributes the newly created grid cells will be initialized with.
     /// @param _margin the margin coordinates to perform the scrolling action into.
-    void scrollDown(int _n, GraphicsAttributes const& _defaultAttributes, Margin const& _margin);
+    void scrollDown(int _n, GraphicsAttributesId _defaultAttributes, Margin const& _margin);
+
+    // {{{ damage tracking
+    /// Records the given columns of the main page line @p _row as modified.
+    void markDamaged(int _row, int _fromColumn, int _toColumn) noexcept
+    {
+        damage_[static_cast<size_t>(_row - 1)].add(_fromColumn, _toColumn);
+    }
+
+    /// Records the given columns of all main page lines in [_fromRow, _toRow] as modified.
+    void markDamaged(int _fromRow, int _toRow, int _fromColumn, int _toColumn) noexcept
+    {
+        for (int row = _fromRow; row <= _toRow; ++row)
+            markDamaged(row, _fromColumn, _toColumn);
+    }
+
+    /// Records the whole main page as modified, e.g. when it needs to be rendered from scratch.
+    void markPageDamaged() noexcept { markDamaged(1, screenSize_.height, 1, screenSize_.width); }
+
+    /// @returns the modified columns of the main page line @p _row.
+    LineDamage const& damage(int _row) const noexcept { return damage_[static_cast<size_t>(_row - 1)]; }
+
+    /// @returns true if any main page line has been modified since the damage was last cleared.
+    bool damaged() const noexcept
+    {
+        return std::any_of(damage_.begin(), damage_.end(), [](LineDamage const& _d) { return !_d.empty(); });
+    }
+
+    void clearDamage() noexcept { std::fill(damage_.begin(), damage_.end(), LineDamage{}); }
+    // }}}
 
     std::string renderTextLineAbsolute(int row) const;
     std::string renderTextLine(int row) const;
@@ -654,54 +1139,307 @@ class Grid {
     /// Empty cells are represented as strings and lines split by LF.
     std::string renderAllText() const;
 
+    /// Storage of all multi-codepoint grapheme clusters referenced by this grid's cells.
+    GraphemeClusterStore& clusters() noexcept { return clusters_; }
+    GraphemeClusterStore const& clusters() const noexcept { return clusters_; }
+
+#if defined(LIBTERMINAL_IMAGES)
+    /// Registers a rasterized image with this grid so that cells can refer to it by Id.
+    ///
+    /// Image slots no longer referenced by any cell are reclaimed lazily on insertion.
+    Cell::ImageId insertImage(std::shared_ptr<RasterizedImage const> _image);
+
+    /// @returns the image fragment to be rendered for the given cell, if any.
+    std::optional<ImageFragment> imageFragment(Cell const& _cell) const;
+
+    CellImageStore const& images() const noexcept { return images_; }
+#endif
+
   private:
+#if defined(LIBTERMINAL_IMAGES)
+    /// Releases all image slots that are not referenced by any cell anymore.
+    void collectImages();
+#endif
+
+    /// Releases all grapheme clusters that are not referenced by any cell anymore.
+    void collectClusters();
+
     /// Ensures the maxHistoryLineCount attribute will be satisified, potentially deleting any
     /// overflowing history line.
     void clampHistory();
-    void appendNewLines(int _count, GraphicsAttributes _attr);
+    void appendNewLines(int _count, GraphicsAttributesId _attr);
+
+    /// Compresses the given cold logical line, unless it is already compressed or contains images.
+    void compressLine(Line& _line);
+
+    /// @returns a handle to the line at absolute offset @p _line, decoding it if necessary.
+    ///
+    /// Lines held in memory uncompressed are referred to without ownership, whereas decoded lines
+    /// are shared with the decoded line cache. Either way, the handle must not be held across
+    /// modifications of the grid.
+    std::shared_ptr<Line const> lineHandleAt(int _line) const;
+
+    /// @returns the decoded history line of the given serial number, or decodes it via @p _decode,
+    ///          evicting the least recently used decoded line if the cache is full.
+    ///
+    /// Cold logical lines are keyed by their serial number, lines of the history file by its complement.
+    template <typename Decode>
+    std::shared_ptr<Line const> decodedLine(int64_t _serial, Decode&& _decode) const;
+
+    /// Drops all decoded history lines, as their serial numbers are about to change.
+    void invalidateDecodedLines() const noexcept;
+
+    // {{{ logical history
+    // The logical lines of the history file, followed by the ones of the cold history area,
+    // share a single physical line layout (see layout_). Logical lines are referred to by their
+    // index into that layout, hence those of the history file come first.
+
+    /// Physical line layout of a logical line of the history file or the cold history area.
+    struct LineLayout {
+        int64_t rowStart; // row number of its first physical line, see historyRowBegin()
+        int length;       // number of cells up to the last non-blank one, or spanning all of its physical lines
+        bool reflowable;  // whether or not it is wrapped at the column count, rather than being cut off
+    };
+
+    /// @returns the number of physical lines a logical line spans at @p _columnCount columns.
+    static int rowCount(LineLayout const& _layout, int _columnCount) noexcept
+    {
+        return _layout.reflowable ? std::max(1, (_layout.length + _columnCount - 1) / _columnCount) : 1;
+    }
+
+    /// @returns the number of logical lines in the history file.
+    int spilledLogicalLineCount() const noexcept { return historyFile_ ? historyFile_->size() : 0; }
+
+    /// @returns the row number of the top-most logical line, which is the origin of the physical line layout.
+    int64_t historyRowBegin() const noexcept { return layout_.empty() ? layoutRowEnd_ : layout_.front().rowStart; }
+
+    /// @returns the row number of the logical line at @p _index, or the end of the layout.
+    int64_t layoutRowStart(size_t _index) const noexcept
+    {
+        return _index < layout_.size() ? layout_[_index].rowStart : layoutRowEnd_;
+    }
+
+    /// @returns the index of the logical line holding the absolute line @p _line,
+    ///          and the offset of that line within the logical line.
+    std::pair<size_t, int> logicalLineAt(int _line) const noexcept;
+
+    /// @returns the column count that the logical line at @p _index is currently laid out for.
+    int layoutColumnCount(size_t _index) const noexcept;
+
+    /// @returns the flags of the logical line at @p _index without decoding it.
+    Line::Flags logicalLineFlags(size_t _index) const noexcept;
+
+    /// @returns a handle to the cells of the logical line at @p _index, decoding it if necessary.
+    std::shared_ptr<Line const> logicalLineHandle(size_t _index) const;
+
+    /// @returns the physical line @p _row of the decoded logical line @p _line at @p _columnCount columns.
+    static Line physicalLine(LineLayout const& _layout, Line const& _line, int _row, int _columnCount);
+
+    /// @returns the layout length of the logical line made of the @p _rowCount physical lines
+    ///          of @p _columnCount columns whose cells are @p _cells.
+    static int logicalLength(Line::Buffer const& _cells, int _rowCount, int _columnCount) noexcept;
+
+    /// Appends the layout of a logical line of @p _length cells spanning @p _rowCount physical lines
+    /// of the current column count, to be reflowed if @p _reflowable.
+    void appendLayout(int _length, int _rowCount, bool _reflowable);
+
+    /// Removes the layout of the logical line at @p _index, moving the lines below up.
+    void eraseLayout(size_t _index);
+
+    /// Moves whole logical lines from the top of the hot history area into the cold history area,
+    /// until the hot history area does not exceed its capacity anymore.
+    ///
+    /// A logical line that is still being written to on the main page is only moved in parts once
+    /// the hot history area exceeds twice its capacity, so that it does not grow without bounds.
+    void freezeHotLines();
+
+    /// Moves the bottom-most cold lines back into the main line buffer, laid out for the current
+    /// column count, until the hot history area holds at least @p _lineCount lines or no cold line is left.
+    void thawColdLines(int _lineCount);
+
+    /// Removes whole cold lines from the top, spanning at least @p _lineCount physical lines,
+    /// moving them to the history file if available.
+    ///
+    /// @returns the number of physical lines removed from memory.
+    int evictColdLines(int _lineCount);
+
+    /// Appends at least the @p _count top-most hot history lines, which are about to be removed
+    /// from memory, to the history file as whole logical lines.
+    ///
+    /// @returns the number of lines spilled, which includes the rest of the last logical line.
+    int spillHotLines(int _count);
+
+    /// Lays out the logical lines [@p _start, @p _end) of the reflow segment @p _segment for the current column count.
+    LineShift reflowLogicalLines(size_t _segment, size_t _start, size_t _end);
+    // }}}
+
+    /// @returns the cell at column @p _column (1-based) of @p _line, or a blank one beyond its size.
+    static Cell cellAt(Line const& _line, int _column) noexcept
+    {
+        return _column <= _line.size() ? _line.at(static_cast<size_t>(_column - 1)) : Cell{};
+    }
+
+    /// Trims the given hot history line in place.
+    void trimLine(Line& _line);
+
+    /// Restores all cells of the given compressed or trimmed line.
+    void expandLine(Line& _line);
+
+    /// Expands all lines of the main line buffer, e.g. prior to operating on the cells of every line.
+    void expandAll();
+
+    /// Moves the lines exceeding the hot history area into the cold history area (see freezeHotLines()),
+    /// and ensures that lines are only trimmed in the hot history area.
+    void updateHistoryLines();
+
+    Line::Buffer takeSpareBuffer();
+
+    /// Appends the given logical line, which is about to be removed from memory, to the history file.
+    ///
+    /// @returns false if the line exceeds the history file's quota, and thus has been dropped.
+    bool spillLine(Line& _line);
+
+    /// @returns the logical line at index @p _index of the history file.
+    Line decodeSpilledLine(int _index) const;
+
+    /// Accounts for the @p _count oldest lines of the history file being evicted.
+    void forgetSpilledLines(int _count);
+
+    /// @returns the number of scrollback lines in the main line buffer (lines_), i.e. the hot history area.
+    int attachedHistoryLineCount() const noexcept { return static_cast<int>(lines_.size()) - screenSize_.height; }
+
+    Lines reflowGrow(Lines& _lines, int _columnCount, int _newColumnCount);
+    Lines reflowShrink(Lines& _lines, int _newColumnCount);
 
   private:
     crispy::Size screenSize_;
     bool reflowOnResize_;
     std::optional<int> maxHistoryLineCount_;
     Lines lines_;
+    mutable GraphemeClusterStore clusters_; // decoding history lines may intern clusters
+    size_t clusterCollectThreshold_ = 256;
+
+    // Logical history state. The layout consists of segments of whole logical lines laid out for
+    // the same column count, and those not laid out for the current column count are pending reflow.
+    // Cold lines are identified by a serial number that, unlike their index, does not change
+    // when lines are removed from the top of the history.
+    struct ReflowSegment {
+        int lineCount;   // number of logical lines
+        int columnCount; // column count the segment's lines are laid out for
+    };
+    std::deque<LineLayout> layout_;             // of the spilled lines, followed by the cold lines
+    int64_t layoutRowEnd_ = 0;                  // row number past the last physical line of the layout
+    std::vector<ReflowSegment> reflowSegments_; // segments of layout_, top to bottom
+    std::deque<Line> coldLines_;                // logical lines, compressed unless they contain images
+    int64_t coldSerialOffset_ = 0;              // serial number of coldLines_.front()
+    std::vector<Line::Buffer> spareBuffers_;    // cell buffers released by compressed lines
+    Line::CompressedBuffer compressionScratch_;
+
+    // On-disk history state.
+    std::unique_ptr<HistoryFile> historyFile_;
+    int64_t spilledSerialOffset_ = 0;               // serial number of the history file's first line
+    std::vector<uint32_t> spilledAttributeRefs_;    // number of spilled attribute runs per attributes Id
+#if defined(LIBTERMINAL_HYPERLINKS)
+    std::unordered_map<HyperlinkId, uint32_t> spilledHyperlinkRefs_; // number of spilled hyperlink runs per Id
+#endif
+
+    // Least recently used cache of decoded cold logical lines and spilled history lines by serial number.
+    using DecodedLines = std::list<std::pair<int64_t, std::shared_ptr<Line const>>>;
+    mutable DecodedLines decodedLines_; // least recently used first
+    mutable std::unordered_map<int64_t, DecodedLines::iterator> decodedLineIndex_;
+
+    std::vector<LineDamage> damage_; // damaged columns of each main page line
+
+    // Asserts that history lines are not decoded concurrently (see Thread safety).
+    struct DecodeCheck {
+        std::atomic<bool> busy = false;
+        DecodeCheck() = default;
+        DecodeCheck(DecodeCheck const&) noexcept {}
+        DecodeCheck& operator=(DecodeCheck const&) noexcept { return *this; }
+    };
+    struct DecodeScope {
+        explicit DecodeScope(DecodeCheck& _check) noexcept: check{_check}
+        {
+            [[maybe_unused]] auto const busy = check.busy.exchange(true, std::memory_order_acquire);
+            assert(!busy && "Grid is accessed concurrently.");
+        }
+        ~DecodeScope() { check.busy.store(false, std::memory_order_release); }
+        DecodeCheck& check;
+    };
+    mutable DecodeCheck decodeCheck_;
+
+#if defined(LIBTERMINAL_IMAGES)
+    CellImageStore images_;
+    size_t imageCollectThreshold_ = 64;
+#endif
 };
 
 // {{{ inlines
 template <typename RendererT>
 inline void Grid::render(RendererT && _render, std::optional<int> _scrollOffset) const
 {
-    for (auto const && [rowNumber, line] : crispy::indexed(pageAtScrollOffset(_scrollOffset), 1))
-    {
-        for (auto const && [colNumber, column] : crispy::indexed(line, 1))
-            _render({rowNumber, colNumber}, column);
+    assert(crispy::ascending(0, _scrollOffset.value_or(0), historyLineCount()) && "Absolute scroll offset must not be negative or overflowing.");
 
-        for (auto const colNumber : crispy::times(line.size() + 1, std::max(0, screenSize_.width - line.size())))
-            _render({rowNumber, colNumber}, Cell{});
-    }
+    for (int rowNumber = 1; rowNumber <= screenSize_.height; ++rowNumber)
+        renderLine(_render, rowNumber, _scrollOffset);
 }
 
-inline Line& Grid::absoluteLineAt(int _line) noexcept
+template <typename RendererT>
+inline void Grid::renderLine(RendererT && _render, int _row, std::optional<int> _scrollOffset) const
+{
+    auto const line = lineHandleAt(_scrollOffset.value_or(historyLineCount()) + _row - 1);
+    for (int colNumber = 1; colNumber <= std::min(line->size(), screenSize_.width); ++colNumber)
+        _render({_row, colNumber}, line->at(static_cast<size_t>(colNumber - 1)));
+
+    for (auto const colNumber : crispy::times(line->size() + 1, std::max(0, screenSize_.width - line->size())))
+        _render({_row, colNumber}, Cell{});
+}
+
+inline Line& Grid::absoluteLineAt(int _line)
 {
-    assert(crispy::ascending(0, _line, static_cast<int>(lines_.size()) - 1));
-    return *next(lines_.begin(), _line);
+    assert(crispy::ascending(spilledLineCount() + coldLineCount(),
+                             _line,
+                             historyLineCount() + screenSize_.height - 1)
+           && "Only lines of the main page or the hot history area can be modified.");
+
+    Line& line = lines_[static_cast<size_t>(_line - spilledLineCount() - coldLineCount())];
+    if (line.trimmed())
+        line.untrim();
+    return line;
 }
 
-inline Line const& Grid::absoluteLineAt(int _line) const noexcept
+inline Line Grid::absoluteLineAt(int _line) const
 {
-    return const_cast<Grid&>(*this).absoluteLineAt(_line);
+    return *lineHandleAt(_line);
+}
+
+inline Line::Flags Grid::absoluteLineFlags(int _line) const noexcept
+{
+    assert(crispy::ascending(0, _line, historyLineCount() + screenSize_.height - 1));
+
+    if (_line < spilledLineCount() + coldLineCount())
+    {
+        auto const [index, row] = logicalLineAt(_line);
+        auto const flags = logicalLineFlags(index);
+        return row == 0 ? flags : (flags & Line::Flags::Wrappable ? Line::Flags::Wrappable : Line::Flags::None)
+                                  | Line::Flags::Wrapped;
+    }
+
+    return lines_[static_cast<size_t>(_line - spilledLineCount() - coldLineCount())].flags();
 }
 
-inline Line& Grid::lineAt(int _line) noexcept
+inline Line& Grid::lineAt(int _line)
 {
     assert(crispy::ascending(1 - historyLineCount(), _line, screenSize_.height));
 
-    return *next(lines_.begin(), historyLineCount() + _line - 1);
+    return absoluteLineAt(historyLineCount() + _line - 1);
 }
 
-inline Line const& Grid::lineAt(int _line) const noexcept
+inline Line Grid::lineAt(int _line) const
 {
-    return const_cast<Grid&>(*this).lineAt(_line);
+    assert(crispy::ascending(1 - historyLineCount(), _line, screenSize_.height));
+
+    return absoluteLineAt(historyLineCount() + _line - 1);
 }
 
 inline int Grid::toAbsoluteLine(int _relativeLine) const noexcept
@@ -714,50 +1452,70 @@ inline int Grid::toRelativeLine(int _absoluteLine) const noexcept
     return _absoluteLine - historyLineCount();
 }
 
-inline Cell& Grid::at(Coordinate const& _coord) noexcept
+inline Cell& Grid::at(Coordinate const& _coord)
 {
-    assert(crispy::ascending(1 - historyLineCount(), _coord.row, screenSize_.height));
     assert(crispy::ascending(1, _coord.column, screenSize_.width));
 
-    if (_coord.row > 0)
-        return (*next(lines_.rbegin(), screenSize_.height - _coord.row))[_coord.column - 1];
-    else
-        return (*next(lines_.begin(), historyLineCount() + _coord.row - 1))[_coord.column - 1];
+    return lineAt(_coord.row)[_coord.column - 1];
 }
 
-inline Cell const& Grid::at(Coordinate const& _coord) const noexcept
+inline Cell Grid::at(Coordinate const& _coord) const
 {
-    return const_cast<Grid&>(*this).at(_coord);
+    assert(crispy::ascending(1 - historyLineCount(), _coord.row, screenSize_.height));
+    assert(crispy::ascending(1, _coord.column, screenSize_.width));
+
+    if (_coord.row > 0)
+        return lines_[static_cast<size_t>(attachedHistoryLineCount() + _coord.row - 1)][_coord.column - 1];
+
+    // Cells of logical lines are taken from them directly rather than materializing the physical line.
+    auto const line = historyLineCount() + _coord.row - 1;
+    if (line < spilledLineCount() + coldLineCount())
+    {
+        auto const [index, row] = logicalLineAt(line);
+        auto const columnCount = layoutColumnCount(index);
+        if (!layout_[index].reflowable)
+            return cellAt(*logicalLineHandle(index), _coord.column);
+        if (_coord.column > columnCount)
+            return Cell{};
+        return cellAt(*logicalLineHandle(index), row * columnCount + _coord.column);
+    }
+
+    return cellAt(*lineHandleAt(line), _coord.column);
 }
 
 inline crispy::range<Lines::const_iterator> Grid::lines(int _start, int _end) const
 {
-    assert(crispy::ascending(0, _start, int(lines_.size()) - 1) && "Absolute scroll offset must not be negative or overflowing.");
-    assert(crispy::ascending(_start, _end, int(lines_.size()) - 1) && "Absolute scroll offset must not be negative or overflowing.");
+    auto const offset = spilledLineCount() + coldLineCount();
+
+    assert(crispy::ascending(offset, _start, historyLineCount() + screenSize_.height) && "Absolute scroll offset must not be negative or overflowing.");
+    assert(crispy::ascending(_start, _end, historyLineCount() + screenSize_.height) && "Absolute scroll offset must not be negative or overflowing.");
 
     return crispy::range<Lines::const_iterator>(
-        next(lines_.cbegin(), _start),
-        next(lines_.cbegin(), _end)
+        std::next(lines_.cbegin(), _start - offset),
+        std::next(lines_.cbegin(), _end - offset)
     );
 }
 
 inline crispy::range<Lines::iterator> Grid::lines(int _start, int _end)
 {
-    assert(crispy::ascending(0, _start, int(lines_.size())) && "Absolute scroll offset must not be negative or overflowing.");
-    assert(crispy::ascending(_start, _end, int(lines_.size())) && "Absolute scroll offset must not be negative or overflowing.");
+    auto const offset = spilledLineCount() + coldLineCount();
+
+    assert(crispy::ascending(offset, _start, historyLineCount() + screenSize_.height) && "Absolute scroll offset must not be negative or overflowing.");
+    assert(crispy::ascending(_start, _end, historyLineCount() + screenSize_.height) && "Absolute scroll offset must not be negative or overflowing.");
 
     return crispy::range<Lines::iterator>(
-        next(lines_.begin(), _start),
-        next(lines_.begin(), _end)
+        std::next(lines_.begin(), _start - offset),
+        std::next(lines_.begin(), _end - offset)
     );
 }
 
 inline crispy::range<Lines::const_iterator> Grid::pageAtScrollOffset(std::optional<int> _scrollOffset) const
 {
-    assert(crispy::ascending(0, _scrollOffset.value_or(0), historyLineCount()) && "Absolute scroll offset must not be negative or overflowing.");
+    auto const offset = spilledLineCount() + coldLineCount();
+
+    assert(crispy::ascending(offset, _scrollOffset.value_or(offset), historyLineCount()) && "Absolute scroll offset must not be negative or overflowing.");
 
-    auto const start = std::next(lines_.cbegin(),
-                                 static_cast<size_t>(_scrollOffset.value_or(historyLineCount())));
+    auto const start = std::next(lines_.cbegin(), _scrollOffset.value_or(historyLineCount()) - offset);
     auto const end = std::next(start, screenSize_.height);
 
     return crispy::range<Lines::const_iterator>(start, end);
@@ -765,15 +1523,14 @@ inline crispy::range<Lines::const_iterator> Grid::pageAtScrollOffset(std::option
 
 inline crispy::range<Lines::iterator> Grid::pageAtScrollOffset(std::optional<int> _scrollOffset)
 {
-    assert(crispy::ascending(0, _scrollOffset.value_or(0), historyLineCount()) && "Absolute scroll offset must not be negative or overflowing.");
+    auto const offset = spilledLineCount() + coldLineCount();
 
-    return crispy::range<Lines::iterator>(
-        std::next(
-            lines_.begin(),
-            static_cast<size_t>(_scrollOffset.value_or(historyLineCount()))
-        ),
-        lines_.end()
-    );
+    assert(crispy::ascending(offset, _scrollOffset.value_or(offset), historyLineCount()) && "Absolute scroll offset must not be negative or overflowing.");
+
+    auto const start = std::next(lines_.begin(), _scrollOffset.value_or(historyLineCount()) - offset);
+    auto const end = std::next(start, screenSize_.height);
+
+    return crispy::range<Lines::iterator>(start, end);
 }
 
 inline crispy::range<Lines::const_iterator> Grid::mainPage() const
@@ -786,13 +1543,22 @@ inline crispy::range<Lines::iterator> Grid::mainPage()
     return pageAtScrollOffset(std::nullopt);
 }
 
+#if defined(LIBTERMINAL_IMAGES)
+inline std::optional<ImageFragment> Grid::imageFragment(Cell const& _cell) const
+{
+    if (auto const id = _cell.imageId(); id != 0)
+        return ImageFragment{images_.at(id), _cell.imageOffset()};
+    return std::nullopt;
+}
+#endif
+
 inline crispy::range<Lines::const_iterator> Grid::scrollbackLines() const
 {
     return crispy::range<Lines::const_iterator>(
         lines_.cbegin(),
         std::next(
             lines_.cbegin(),
-            static_cast<size_t>(historyLineCount())
+            static_cast<size_t>(attachedHistoryLineCount())
         )
     );
 }
@@ -58,8 +58,54 @@ namespace // {{{ helper
     }
 } // }}}
 
+TEST_CASE("Cell.appendCharacter.interned", "[grid]")
+{
+    auto clusters = GraphemeClusterStore{};
+
+    auto a = Cell{U'\u2139', {}};
+    a.appendCharacter(U'\uFE0F', clusters);
+    CHECK(a.codepointCount() == 2);
+    CHECK(a.codepoint() == U'\u2139');
+    CHECK(a.codepoints(clusters) == U"\u2139\uFE0F");
+
+    auto b = Cell{U'\u2139', {}};
+    b.appendCharacter(U'\uFE0F', clusters);
+    CHECK(a == b);
+    CHECK(clusters.size() == 1);
+
+    b.setCharacter('X');
+    CHECK(b.codepointCount() == 1);
+    CHECK(b.codepoints(clusters) == U"X");
+}
+
+TEST_CASE("GraphicsAttributesPool.intern", "[grid]")
+{
+    auto pool = GraphicsAttributesPool{};
+    CHECK(pool.tryIntern(GraphicsAttributes{}) == GraphicsAttributesId{0});
+
+    auto red = GraphicsAttributes{};
+    red.foregroundColor = RGBColor{0xFF, 0x00, 0x00};
+    auto yellow = GraphicsAttributes{};
+    yellow.foregroundColor = RGBColor{0xFF, 0xFF, 0x00};
+
+    auto const redId = pool.tryIntern(red);
+    auto const yellowId = pool.tryIntern(yellow);
+    REQUIRE(redId.has_value());
+    REQUIRE(yellowId.has_value());
+    CHECK(*redId != *yellowId);
+    CHECK(pool.tryIntern(red) == redId);
+    CHECK(pool.at(*yellowId) == yellow);
+
+    auto used = std::vector<bool>(pool.size(), false);
+    used[*yellowId] = true;
+    pool.collect(used);
+    CHECK(pool.tryIntern(yellow) == yellowId);
+    CHECK(pool.tryIntern(red) == redId); // reuses the released slot
+}
+
 TEST_CASE("Line.reflow.unwrappable", "[grid]")
 {
+    auto const clusters = GraphemeClusterStore{};
     auto line = Line(5, "ABCDE"sv, Line::Flags::None);
     REQUIRE(!line.wrappable());
     REQUIRE(!line.wrapped());
@@ -67,12 +113,13 @@ TEST_CASE("Line.reflow.unwrappable", "[grid]")
     auto const reflowed = line.reflow(3);
     CHECK(!line.wrapped());
     CHECK(line.size() == 3);
-    CHECK(line.toUtf8() == "ABC");
+    CHECK(line.toUtf8(clusters) == "ABC");
     CHECK(reflowed.size() == 0);
 }
 
 TEST_CASE("Line.reflow.wrappable", "[grid]")
 {
+    auto const clusters = GraphemeClusterStore{};
     auto line = Line(5, "ABCDE"sv, Line::Flags::Wrappable);
     REQUIRE(line.wrappable());
     REQUIRE(!line.wrapped());
@@ -80,24 +127,64 @@ TEST_CASE("Line.reflow.wrappable", "[grid]")
     auto const reflowed = Line(line.reflow(3), line.inheritableFlags() | Line::Flags::Wrapped);
     CHECK(!line.wrapped());
     CHECK(line.size() == 3);
-    CHECK(line.toUtf8() == "ABC");
+    CHECK(line.toUtf8(clusters) == "ABC");
     CHECK(reflowed.size() == 2);
-    CHECK(reflowed.toUtf8() == "DE");
+    CHECK(reflowed.toUtf8(clusters) == "DE");
 }
 
 TEST_CASE("Line.reflow.empty", "[grid]")
 {
+    auto const clusters = GraphemeClusterStore{};
     auto line = Line(5, Cell{}, Line::Flags::Wrappable);
     REQUIRE(!line.wrapped());
     REQUIRE(line.size() == 5);
-    REQUIRE(line.toUtf8() == "     ");
+    REQUIRE(line.toUtf8(clusters) == "     ");
 
     auto const reflowed = Line(line.reflow(3), line.flags());
     CHECK(!line.wrapped());
     CHECK(line.size() == 3);
-    CHECK(line.toUtf8() == "   ");
+    CHECK(line.toUtf8(clusters) == "   ");
     CHECK(reflowed.size() == 0);
-    CHECK(reflowed.toUtf8() == "");
+    CHECK(reflowed.toUtf8(clusters) == "");
+}
+
+TEST_CASE("Line.compress", "[grid]")
+{
+    auto clusters = GraphemeClusterStore{};
+    auto scratch = Line::CompressedBuffer{};
+
+    auto line = Line(8, "abc", Line::Flags::Wrappable);
+    line[1].setCharacter(U'\u00E4');
+    line[2].setCharacter(U'\u20AC');
+    line[1].setAttributes(3);
+    line[2].setAttributes(3);
+    line[3].setCharacter(U'\u2139');
+    line[3].appendCharacter(U'\uFE0F', clusters);
+    line[4].setCharacter('\t');
+    line[5].setCharacter('W');
+    line[5].setWidth(2);
+    auto const original = line;
+
+    auto cells = line.compress(clusters, scratch);
+    CHECK(line.compressed());
+    CHECK(line.size() == 8);
+    CHECK(line.wrappable());
+    CHECK(cells.size() == 8);
+
+    auto used = std::vector<bool>(4, false);
+    line.markUsedAttributes(used);
+    CHECK(used == std::vector<bool>{true, false, false, true});
+
+    line.decompress(clusters, move(cells));
+    REQUIRE(!line.compressed());
+    REQUIRE(line.size() == 8);
+    for (int i = 0; i < 8; ++i)
+    {
+        INFO(fmt::format("column {}", i));
+        CHECK(line[i] == original[i]);
+        CHECK(line[i].width() == original[i].width());
+    }
+    CHECK(line.toUtf8(clusters) == original.toUtf8(clusters));
 }
 
 TEST_CASE("Grid.reflow.shrink.wrappable", "[grid]")
@@ -440,3 +527,388 @@ TEST_CASE("Grid.reflow.tripple", "[grid]")
         // }}}
     }
 }
+
+TEST_CASE("Grid.scrollUp.recycle_at_history_limit", "[grid]")
+{
+    auto grid = Grid(Size{3, 2}, false, 2);
+    auto const fullMargin = Margin{Margin::Range{1, 2}, Margin::Range{1, 3}};
+
+    grid.lineAt(1).setText("ABC");
+    grid.lineAt(2).setText("DEF");
+    grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    grid.lineAt(2).setText("GHI");
+    grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    grid.lineAt(2).setText("JKL");
+    REQUIRE(grid.historyLineCount() == 2);
+
+    // history is full, so any further scroll recycles the oldest line.
+    grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    logGridText(grid, "after scrolling at history limit");
+    CHECK(grid.historyLineCount() == 2);
+    CHECK(grid.renderTextLine(-1) == "DEF");
+    CHECK(grid.renderTextLine(0) == "GHI");
+    CHECK(grid.renderTextLine(1) == "JKL");
+    CHECK(grid.renderTextLine(2) == "   ");
+}
+
+TEST_CASE("Grid.history.cold_lines", "[grid]")
+{
+    auto grid = Grid(Size{3, 1}, false, 100);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 3}};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        grid.lineAt(1).setText(fmt::format("{:03}", i));
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    }
+    REQUIRE(grid.historyLineCount() == 10);
+    REQUIRE(grid.coldLineCount() == 10 - Grid::HotHistoryPageCount);
+    CHECK(grid.scrollbackLines().size() == Grid::HotHistoryPageCount);
+
+    // cold lines are transparently decoded on access, but kept compressed
+    CHECK(grid.renderTextLine(-9) == "000");
+    CHECK(grid.coldLineCount() == 10 - Grid::HotHistoryPageCount);
+    CHECK(grid.renderTextLine(0) == "009");
+
+    // scrolling further does not lose already compressed lines
+    grid.lineAt(1).setText("010");
+    grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    CHECK(grid.renderTextLine(-10) == "000");
+    CHECK(grid.renderTextLine(-9) == "001");
+    CHECK(grid.renderTextLine(0) == "010");
+}
+
+TEST_CASE("Grid.history.cold_lines.clusters", "[grid]")
+{
+    auto constexpr LineCount = 600;
+    auto grid = Grid(Size{3, 1}, false, LineCount);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 3}};
+
+    for (int i = 0; i < LineCount; ++i)
+    {
+        grid.lineAt(1)[0].setCharacter(U'\u4E00' + static_cast<char32_t>(i));
+        grid.lineAt(1)[0].appendCharacter(U'\u0301', grid.clusters());
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    }
+
+    // Compressed lines do not refer to clusters by Id, hence those are released eventually.
+    CHECK(grid.clusters().size() < static_cast<size_t>(LineCount));
+
+    auto const& constGrid = grid;
+    auto const first = constGrid.at({1 - LineCount, 1});
+    CHECK(first.codepoints(grid.clusters()) == U"\u4E00\u0301");
+    CHECK(constGrid.at({0, 1}).codepoints(grid.clusters()) == std::u32string{U'\u4E00' + LineCount - 1, U'\u0301'});
+}
+
+TEST_CASE("Grid.history.cold_lines.decoded_cache", "[grid]")
+{
+    auto const coldCount = static_cast<int>(Grid::DecodedLineCacheSize) + 10;
+    auto grid = Grid(Size{3, 1}, false, coldCount + Grid::HotHistoryPageCount);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 3}};
+
+    for (int i = 0; i < coldCount + Grid::HotHistoryPageCount; ++i)
+    {
+        grid.lineAt(1).setText(fmt::format("{:03}", i));
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    }
+    REQUIRE(grid.coldLineCount() == coldCount);
+
+    auto const& constGrid = grid;
+
+    // Copies of history lines outlive the decoded line cache.
+    Line const first = constGrid.absoluteLineAt(0);
+    for (int i = 1; i < coldCount; ++i)
+        CHECK(constGrid.absoluteLineAt(i).toUtf8(grid.clusters()) == fmt::format("{:03}", i));
+    CHECK(!first.compressed());
+    CHECK(first.toUtf8(grid.clusters()) == "000");
+
+    // Lines evicted from the decoded line cache are decoded again.
+    CHECK(constGrid.at({1 - grid.historyLineCount(), 3}).codepoint() == '0');
+    CHECK(constGrid.at({1 - grid.historyLineCount(), 3}).codepoint() == '0');
+
+    grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    CHECK(grid.renderTextLine(1 - grid.historyLineCount()) == "001");
+}
+
+TEST_CASE("Grid.reflow.lazy", "[grid]")
+{
+    auto grid = Grid(Size{4, 1}, true, 100);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 4}};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        grid.lineAt(1).setText(fmt::format("{:04}", i));
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    }
+    REQUIRE(grid.coldLineCount() == 7);
+
+    (void) grid.resize(Size{2, 1}, Coordinate{1, 1}, false);
+
+    // Only the hot history area has been reflowed, the cold history lines are pending reflow.
+    REQUIRE(grid.pendingReflowLineCount() == 7);
+    CHECK(grid.historyLineCount() == 7 + 3 * 2);
+    CHECK(grid.renderTextLine(-12) == "00");
+    CHECK(grid.renderTextLine(-5) == "00");
+    CHECK(grid.renderTextLine(-2) == "08");
+    CHECK(grid.renderTextLine(0) == "09");
+
+    // Pending lines are reflowed bottom-up, shifting the lines below.
+    auto const shift = grid.reflowPendingLines(2);
+    CHECK(shift.line == 7);
+    CHECK(shift.delta == 2);
+    CHECK(grid.pendingReflowLineCount() == 5);
+    CHECK(grid.historyLineCount() == 5 + 5 * 2);
+
+    while (grid.pendingReflowLineCount() != 0)
+        (void) grid.reflowPendingLines(2);
+
+    auto expectedText = string{};
+    for (int i = 0; i < 10; ++i)
+        expectedText += fmt::format("00\n{:02}\n", i);
+    expectedText += "  \n";
+
+    CHECK(grid.historyLineCount() == 20);
+    CHECK(grid.coldLineCount() == 7 * 2 + 2 * 2);
+    CHECK(grid.renderAllText() == expectedText);
+}
+
+TEST_CASE("Grid.reflow.lazy.within", "[grid]")
+{
+    auto grid = Grid(Size{4, 1}, true, 100);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 4}};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        grid.lineAt(1).setText(fmt::format("{:04}", i));
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    }
+    (void) grid.resize(Size{2, 1}, Coordinate{1, 1}, false);
+    REQUIRE(grid.pendingReflowLineCount() == 7);
+
+    // Only the lines within the range are reflowed, leaving the ones above and below pending.
+    auto const shift = grid.reflowPendingLinesWithin(2, 2);
+    REQUIRE(shift.has_value());
+    CHECK(shift->line == 4);
+    CHECK(shift->delta == 2);
+    CHECK(grid.pendingReflowLineCount() == 5);
+    CHECK(grid.historyLineCount() == 5 + 2 * 2 + 3 * 2);
+    CHECK(grid.renderTextLine(-12) == "00");
+    CHECK(grid.renderTextLine(-11) == "02");
+    CHECK(grid.renderTextLine(-10) == "00");
+    CHECK(grid.renderTextLine(-9) == "03");
+    CHECK(!grid.reflowPendingLinesWithin(2, 4).has_value());
+
+    while (grid.pendingReflowLineCount() != 0)
+        (void) grid.reflowPendingLines(2);
+
+    auto expectedText = string{};
+    for (int i = 0; i < 10; ++i)
+        expectedText += fmt::format("00\n{:02}\n", i);
+    expectedText += "  \n";
+
+    CHECK(grid.historyLineCount() == 20);
+    CHECK(grid.renderAllText() == expectedText);
+}
+
+TEST_CASE("Grid.reflow.lazy.logical_lines", "[grid]")
+{
+    auto grid = Grid(Size{4, 1}, true, 100);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 4}};
+    auto const writeLine = [&](std::string_view _text, bool _wrapped) {
+        grid.lineAt(1).setText(_text);
+        grid.lineAt(1).setWrapped(_wrapped);
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    };
+
+    writeLine("ABCD", false);
+    writeLine("EFGH", true);
+    for (int i = 1; i <= 4; ++i)
+        writeLine(fmt::format("{:04}", i), false);
+
+    // The wrapped line moved into the cold history area as a single logical line.
+    REQUIRE(grid.coldLineCount() == 3);
+    CHECK(grid.renderTextLine(-5) == "ABCD");
+    CHECK(grid.renderTextLine(-4) == "EFGH");
+    CHECK(grid.absoluteLineFlags(1) & Line::Flags::Wrapped);
+    CHECK(grid.computeRelativeLineNumberFromBottom(5) == -3);
+    CHECK(grid.computeRelativeLineNumberFromBottom(6) == -5);
+
+    // Cold lines keep their layout until reflowed.
+    (void) grid.resize(Size{8, 1}, Coordinate{1, 1}, false);
+    REQUIRE(grid.pendingReflowLineCount() == 3);
+    CHECK(grid.historyLineCount() == 6);
+    CHECK(grid.renderTextLine(-5) == "ABCD    ");
+
+    auto const shift = grid.reflowPendingLines(10);
+    CHECK(shift.line == 3);
+    CHECK(shift.delta == -1);
+    CHECK(grid.pendingReflowLineCount() == 0);
+    CHECK(grid.historyLineCount() == 5);
+    CHECK(grid.renderTextLine(-4) == "ABCDEFGH");
+    CHECK(grid.renderTextLine(-3) == "0001    ");
+
+    (void) grid.resize(Size{2, 1}, Coordinate{1, 1}, false);
+    while (grid.pendingReflowLineCount() != 0)
+        (void) grid.reflowPendingLines(1);
+
+    CHECK(grid.historyLineCount() == 12);
+    CHECK(grid.renderAllText() == "AB\nCD\nEF\nGH\n00\n01\n00\n02\n00\n03\n00\n04\n  \n");
+    CHECK(grid.computeRelativeLineNumberFromBottom(6) == -11);
+}
+
+TEST_CASE("Grid.history.cold_lines.long_logical_line", "[grid]")
+{
+    auto constexpr LineCount = 40;
+    auto grid = Grid(Size{2, 1}, true, 1000);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 2}};
+
+    // A logical line that is still being written to does not keep growing the hot history area.
+    for (int i = 0; i < LineCount; ++i)
+    {
+        grid.lineAt(1).setText(fmt::format("{:02}", i));
+        grid.lineAt(1).setWrapped(i != 0);
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+        grid.lineAt(1).setWrapped(true);
+        CHECK(grid.scrollbackLines().size() < 2 * Grid::HotHistoryPageCount);
+    }
+
+    REQUIRE(grid.historyLineCount() == LineCount);
+    CHECK(grid.coldLineCount() > 0);
+    for (int i = 0; i < LineCount; ++i)
+        CHECK(grid.renderTextLineAbsolute(i) == fmt::format("{:02}", i));
+    CHECK(grid.computeRelativeLineNumberFromBottom(1) == 1 - LineCount);
+}
+
+TEST_CASE("Grid.history.trimmed_lines", "[grid]")
+{
+    auto grid = Grid(Size{10, 1}, false, 100);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 10}};
+    auto const fillAttributes = static_cast<GraphicsAttributesId>(1);
+
+    grid.lineAt(1).setText("ab");
+    for (int column = 3; column <= 10; ++column)
+        grid.at({1, column}).setAttributes(fillAttributes);
+    grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+
+    // Lines moving into history only hold their occupied columns plus a fill cell.
+    Line& line = *grid.lines(0, 1).begin();
+    REQUIRE(line.trimmed());
+    CHECK(line.buffer().size() == 3);
+    CHECK(line.buffer().capacity() >= 10); // trimmed in place
+    CHECK(line.size() == 10);
+    CHECK(line.toUtf8(grid.clusters()) == "ab        ");
+    CHECK(line.toUtf8Trimmed(grid.clusters()) == "ab");
+    CHECK(grid.renderTextLine(0) == "ab        ");
+    auto const& constGrid = grid;
+    CHECK(constGrid.at({0, 10}).attributesId() == fillAttributes);
+    CHECK(line.trimmed());
+
+    // Fill cells survive compression.
+    for (int i = 0; i < Grid::HotHistoryPageCount; ++i)
+        grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+    REQUIRE(grid.coldLineCount() == 1);
+    CHECK(grid.renderTextLine(-3) == "ab        ");
+    CHECK(constGrid.at({-3, 10}).attributesId() == fillAttributes);
+
+    // Mutable access restores all cells of a trimmed line first.
+    REQUIRE(grid.lines(1, 2).begin()->trimmed());
+    grid.at({-2, 10}).setAttributes(fillAttributes);
+    CHECK(!grid.lines(1, 2).begin()->trimmed());
+
+    // Lines moving back into the main page are restored to their full size.
+    (void) grid.resize(Size{10, 5}, Coordinate{1, 1}, false);
+    CHECK(!grid.lineAt(1).trimmed());
+    CHECK(grid.lineAt(1).buffer().size() == 10);
+    CHECK(grid.at({1, 10}).attributesId() == fillAttributes);
+}
+
+TEST_CASE("Grid.history.file", "[grid]")
+{
+    auto grid = Grid(Size{3, 1}, false, 2);
+    auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 3}};
+    auto const scrollLines = [&](int _count) {
+        for (int i = 0; i < _count; ++i)
+        {
+            grid.lineAt(1).setText(fmt::format("{:03}", i));
+            grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+        }
+    };
+
+    SECTION("spill") {
+        grid.setHistoryFile(HistoryFile::create(4096));
+        REQUIRE(grid.historyFile() != nullptr);
+
+        scrollLines(6);
+        CHECK(grid.residentHistoryLineCount() == 2);
+        CHECK(grid.spilledLineCount() == 4);
+        CHECK(grid.historyLineCount() == 6);
+        CHECK(grid.renderAllText() == "000\n001\n002\n003\n004\n005\n   \n");
+        CHECK(grid.renderTextLine(-5) == "000");
+
+        grid.clearHistory();
+        CHECK(grid.historyLineCount() == 0);
+    }
+
+    SECTION("quota") {
+        grid.setHistoryFile(HistoryFile::create(30));
+        REQUIRE(grid.historyFile() != nullptr);
+
+        scrollLines(6);
+        auto const spilled = grid.spilledLineCount();
+        REQUIRE(spilled > 0);
+        REQUIRE(spilled < 4);
+
+        // only the most recently spilled lines are kept
+        CHECK(grid.renderTextLineAbsolute(0) == fmt::format("{:03}", 4 - spilled));
+        CHECK(grid.renderTextLineAbsolute(spilled - 1) == "003");
+        CHECK(grid.renderTextLineAbsolute(spilled) == "004");
+    }
+}
+
+TEST_CASE("Grid.history.file.reflow", "[grid]")
+{
+    // The history file is fed from the cold history area, or from the hot one if the history limit is below it.
+    for (auto const historyLimit : {Grid::HotHistoryPageCount + 2, 2})
+    {
+        auto grid = Grid(Size{4, 1}, true, historyLimit);
+        auto const fullMargin = Margin{Margin::Range{1, 1}, Margin::Range{1, 4}};
+        auto const writeLine = [&](std::string_view _text, bool _wrapped) {
+            grid.lineAt(1).setText(_text);
+            grid.lineAt(1).setWrapped(_wrapped);
+            grid.scrollUp(1, GraphicsAttributesId{}, fullMargin);
+        };
+
+        grid.setHistoryFile(HistoryFile::create(4096));
+        writeLine("ABCD", false);
+        writeLine("EFGH", true);
+        for (int i = 1; i <= 8; ++i)
+            writeLine(fmt::format("{:04}", i), false);
+
+        // The wrapped line moved into the history file as a single logical line.
+        auto const spilled = grid.spilledLineCount();
+        REQUIRE(spilled > 2);
+        CHECK(grid.renderTextLineAbsolute(0) == "ABCD");
+        CHECK(grid.renderTextLineAbsolute(1) == "EFGH");
+        CHECK(grid.absoluteLineFlags(1) & Line::Flags::Wrapped);
+
+        // Spilled lines keep their layout until reflowed.
+        (void) grid.resize(Size{8, 1}, Coordinate{1, 1}, false);
+        CHECK(grid.spilledLineCount() == spilled);
+        CHECK(grid.renderTextLineAbsolute(0) == "ABCD    ");
+        while (grid.pendingReflowLineCount() != 0)
+            (void) grid.reflowPendingLines(2);
+        CHECK(grid.spilledLineCount() == spilled - 1);
+        CHECK(grid.renderTextLineAbsolute(0) == "ABCDEFGH");
+        CHECK(grid.renderTextLineAbsolute(1) == "0001    ");
+
+        (void) grid.resize(Size{2, 1}, Coordinate{1, 1}, false);
+        while (grid.pendingReflowLineCount() != 0)
+            (void) grid.reflowPendingLines(2);
+        CHECK(grid.renderTextLineAbsolute(0) == "AB");
+        CHECK(grid.renderTextLineAbsolute(3) == "GH");
+        CHECK(grid.absoluteLineFlags(3) & Line::Flags::Wrapped);
+        CHECK(grid.renderTextLineAbsolute(4) == "00");
+        CHECK(grid.renderTextLineAbsolute(5) == "01");
+        CHECK(!(grid.absoluteLineFlags(4) & Line::Flags::Wrapped));
+    }
+}
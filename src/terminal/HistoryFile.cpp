@@ -0,0 +1,123 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/HistoryFile.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::unique_ptr;
+
+namespace terminal {
+
+unique_ptr<HistoryFile> HistoryFile::create([[maybe_unused]] size_t _quota)
+{
+#if !defined(_WIN32)
+    if (_quota == 0)
+        return nullptr;
+
+    char const* tempDirectory = getenv("TMPDIR");
+    auto path = string(tempDirectory && *tempDirectory ? tempDirectory : "/tmp") + "/libterminal-history-XXXXXX";
+
+    int const fd = mkstemp(path.data());
+    if (fd < 0)
+        return nullptr;
+
+    // The mapping keeps the file alive, and the file is removed as soon as it is unmapped.
+    unlink(path.c_str());
+
+    if (ftruncate(fd, static_cast<off_t>(_quota)) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* data = mmap(nullptr, _quota, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    return unique_ptr<HistoryFile>(new HistoryFile(static_cast<uint8_t*>(data), _quota));
+#else
+    // TODO: CreateFileMapping() based implementation.
+    return nullptr;
+#endif
+}
+
+HistoryFile::~HistoryFile()
+{
+#if !defined(_WIN32)
+    munmap(data_, quota_);
+#endif
+}
+
+size_t HistoryFile::writeOffset(size_t _size) const noexcept
+{
+    return head_ + _size <= quota_ ? head_ : 0;
+}
+
+int HistoryFile::evictionCount(size_t _size) const noexcept
+{
+    auto const offset = writeOffset(_size);
+    auto const wrapping = offset != head_;
+
+    // The records following the write head are the oldest ones, so that evicted records
+    // always form a prefix of records_.
+    int count = 0;
+    for (Extent const& record : records_)
+    {
+        auto const skipped = wrapping && record.offset >= head_;
+        auto const overlapping = record.offset < offset + _size && offset < record.offset + record.size;
+        if (!skipped && !overlapping)
+            break;
+        ++count;
+    }
+    return count;
+}
+
+int HistoryFile::append(uint8_t const* _data, size_t _size)
+{
+    if (_size == 0 || _size > quota_)
+        return 0;
+
+    auto const evicted = evictionCount(_size);
+    records_.erase(records_.begin(), std::next(records_.begin(), evicted));
+
+    auto const offset = writeOffset(_size);
+    std::memcpy(data_ + offset, _data, _size);
+    records_.emplace_back(Extent{offset, _size});
+    head_ = offset + _size;
+
+    return evicted;
+}
+
+HistoryFile::Record HistoryFile::at(int _index) const noexcept
+{
+    auto const& record = records_[static_cast<size_t>(_index)];
+    return Record(data_ + record.offset, record.size);
+}
+
+void HistoryFile::clear() noexcept
+{
+    records_.clear();
+    head_ = 0;
+}
+
+} // end namespace
@@ -0,0 +1,86 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <crispy/span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace terminal {
+
+/**
+ * Append-only, memory-mapped storage for scrollback history lines that have been
+ * evicted from a Grid's in-memory history.
+ *
+ * The file is an anonymous temporary file (unlinked right after creation) of exactly
+ * @c quota bytes that is used as a ring: appending a record that does not fit anymore
+ * evicts the oldest records.
+ *
+ * Records are opaque byte sequences, addressed by their 0-based index, oldest first.
+ */
+class HistoryFile {
+  public:
+    using Record = crispy::span<uint8_t const>;
+
+    /// Creates a new history file of @p _quota bytes within the temporary directory.
+    ///
+    /// @returns the history file or nullptr if it could not be created or mapped into memory.
+    static std::unique_ptr<HistoryFile> create(size_t _quota);
+
+    HistoryFile(HistoryFile const&) = delete;
+    HistoryFile& operator=(HistoryFile const&) = delete;
+    ~HistoryFile();
+
+    size_t quota() const noexcept { return quota_; }
+
+    /// @returns number of records currently stored.
+    int size() const noexcept { return static_cast<int>(records_.size()); }
+
+    /// @returns number of (oldest) records that would be evicted by appending a record of @p _size bytes.
+    int evictionCount(size_t _size) const noexcept;
+
+    /// Appends the given record, evicting the oldest records as needed.
+    ///
+    /// Records larger than the quota are ignored.
+    ///
+    /// @returns number of evicted records.
+    int append(uint8_t const* _data, size_t _size);
+
+    /// @returns the record at index @p _index. The returned span is valid until the next append() or clear().
+    Record at(int _index) const noexcept;
+
+    /// Removes all records.
+    void clear() noexcept;
+
+  private:
+    struct Extent {
+        size_t offset;
+        size_t size;
+    };
+
+    HistoryFile(uint8_t* _data, size_t _quota) noexcept : data_{_data}, quota_{_quota} {}
+
+    /// @returns the offset the next record of @p _size bytes will be written to.
+    size_t writeOffset(size_t _size) const noexcept;
+
+    uint8_t* data_;
+    size_t quota_;
+    size_t head_ = 0;
+    std::deque<Extent> records_;
+};
+
+} // end namespace
@@ -13,8 +13,14 @@
  */
 #pragma once
 
+#include <terminal/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <list>
 #include <memory>
 
@@ -72,6 +78,108 @@ struct HyperlinkInfo { // TODO: rename to Hyperlink
 
 using HyperlinkRef = std::shared_ptr<HyperlinkInfo>;
 
+/// Small integer handle to a hyperlink, as stored in grid cells. 0 means no hyperlink.
+using HyperlinkId = uint32_t;
+
+/// Bounded store of hyperlinks, addressed by monotonically increasing HyperlinkId.
+///
+/// Once the capacity is reached, the owner is expected to collect() the hyperlinks not referenced
+/// by any cell anymore, of which the least recently used ones are evicted. A hyperlink counts as
+/// used when it is added or looked up again by its (OSC 8) user-id, i.e. whenever it starts being
+/// written to the screen. Referenced hyperlinks are never evicted.
+class HyperlinkStorage {
+  public:
+    explicit HyperlinkStorage(size_t _capacity = 1024): capacity_{_capacity}, collectThreshold_{_capacity} {}
+
+    /// Adds the given hyperlink and returns its newly assigned Id.
+    HyperlinkId add(HyperlinkRef _hyperlink)
+    {
+        auto const id = nextId_++;
+        if (!_hyperlink->id.empty())
+            userIds_[_hyperlink->id] = id;
+        recentlyUsed_.push_back(id);
+        links_.emplace(id, Entry{std::move(_hyperlink), std::prev(recentlyUsed_.end())});
+        return id;
+    }
+
+    /// @returns the Id of the most recent hyperlink with the given (OSC 8) user-id, or 0 if none.
+    ///
+    /// The hyperlink found counts as used.
+    HyperlinkId findByUserId(std::string const& _userId)
+    {
+        auto const i = userIds_.find(_userId);
+        if (i == userIds_.end())
+            return 0;
+
+        auto const& entry = links_.at(i->second);
+        recentlyUsed_.splice(recentlyUsed_.end(), recentlyUsed_, entry.recentlyUsed);
+        return i->second;
+    }
+
+    /// @returns the hyperlink for the given Id, or nullptr if it is 0 or has been evicted already.
+    HyperlinkRef at(HyperlinkId _id) const noexcept
+    {
+        if (auto const i = links_.find(_id); i != links_.end())
+            return i->second.hyperlink;
+        return nullptr;
+    }
+
+    /// Forgets all user-ids, such that subsequent hyperlinks with an already known
+    /// user-id will be treated as new ones. Existing Ids remain valid.
+    void clearUserIds() { userIds_.clear(); }
+
+    /// Tests whether unreferenced hyperlinks should be collected before adding another one.
+    bool needsCollect() const noexcept { return links_.size() >= collectThreshold_; }
+
+    /// Evicts the least recently used hyperlinks that are not contained in @p _used,
+    /// until a quarter of the capacity is available again.
+    ///
+    /// If too many hyperlinks are still referenced, the storage grows beyond its capacity,
+    /// and the next collection is deferred by another quarter of the capacity.
+    void collect(std::unordered_set<HyperlinkId> const& _used)
+    {
+        auto const targetSize = capacity_ - capacity_ / 4;
+        for (auto i = recentlyUsed_.begin(); i != recentlyUsed_.end() && links_.size() > targetSize; )
+        {
+            auto const id = *i++;
+            if (!_used.count(id))
+                evict(id);
+        }
+
+        collectThreshold_ = std::max(capacity_, links_.size() + std::max(capacity_ / 4, size_t{1}));
+        if (links_.size() >= capacity_)
+            debuglog(TerminalTag).write("Hyperlink storage exceeds its capacity of {} entries, "
+                                        "as {} hyperlinks are still referenced.",
+                                        capacity_, links_.size());
+    }
+
+    size_t size() const noexcept { return links_.size(); }
+
+  private:
+    struct Entry {
+        HyperlinkRef hyperlink;
+        std::list<HyperlinkId>::iterator recentlyUsed;
+    };
+
+    void evict(HyperlinkId _id)
+    {
+        auto const i = links_.find(_id);
+        debuglog(TerminalTag).write("Evicting unreferenced hyperlink {}: {}", _id, i->second.hyperlink->uri);
+
+        if (auto u = userIds_.find(i->second.hyperlink->id); u != userIds_.end() && u->second == _id)
+            userIds_.erase(u);
+        recentlyUsed_.erase(i->second.recentlyUsed);
+        links_.erase(i);
+    }
+
+    size_t capacity_;
+    size_t collectThreshold_;
+    HyperlinkId nextId_ = 1;
+    std::unordered_map<HyperlinkId, Entry> links_;
+    std::list<HyperlinkId> recentlyUsed_; // least recently used first
+    std::unordered_map<std::string, HyperlinkId> userIds_;
+};
+
 bool is_local(HyperlinkInfo const& _hyperlink);
 
 } // end namespace
@@ -0,0 +1,69 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Hyperlink.h>
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace terminal;
+using namespace std;
+
+namespace
+{
+    HyperlinkRef link(string _id, string _uri)
+    {
+        return make_shared<HyperlinkInfo>(HyperlinkInfo{move(_id), move(_uri)});
+    }
+}
+
+TEST_CASE("HyperlinkStorage.capacity", "[hyperlink]")
+{
+    auto storage = HyperlinkStorage{4};
+
+    auto const a = storage.add(link("a", "https://a/"));
+    auto const b = storage.add(link("", "https://b/"));
+    auto const c = storage.add(link("c", "https://c/"));
+    CHECK(!storage.needsCollect());
+    auto const d = storage.add(link("", "https://d/"));
+    REQUIRE(storage.size() == 4);
+    REQUIRE(storage.needsCollect());
+
+    // Reusing "a" makes b the least recently used one, but b is still referenced.
+    CHECK(storage.findByUserId("a") == a);
+    storage.collect({b});
+    CHECK(storage.size() == 3);
+    CHECK(storage.at(c) == nullptr);
+    CHECK(storage.findByUserId("c") == 0);
+    CHECK(storage.at(a)->uri == "https://a/");
+    CHECK(storage.at(b)->uri == "https://b/");
+    CHECK(storage.at(d)->uri == "https://d/");
+
+    // Referenced hyperlinks are kept even beyond the capacity.
+    auto const e = storage.add(link("e", "https://e/"));
+    REQUIRE(storage.needsCollect());
+    storage.collect({a, b, d, e});
+    CHECK(storage.size() == 4);
+    CHECK(!storage.needsCollect());
+
+    auto const f = storage.add(link("", "https://f/"));
+    CHECK(storage.size() == 5);
+    REQUIRE(storage.needsCollect());
+    storage.collect({f});
+    CHECK(storage.size() == 3);
+    CHECK(storage.at(b) == nullptr);
+    CHECK(storage.at(d) == nullptr);
+    CHECK(storage.findByUserId("a") == a);
+    CHECK(storage.findByUserId("e") == e);
+    CHECK(storage.at(f)->uri == "https://f/");
+}
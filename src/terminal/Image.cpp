@@ -97,6 +97,25 @@ shared_ptr<Image const> ImagePool::create(ImageFormat _format, Size _size, Image
                              [this](Image* _image) { removeImage(_image); });
 }
 
+Image::Data ImagePool::acquireData()
+{
+    auto const _l = std::lock_guard{recycledData_->lock};
+    if (recycledData_->buffers.empty())
+        return Image::Data{};
+
+    auto data = move(recycledData_->buffers.back());
+    recycledData_->buffers.pop_back();
+    recycledData_->bytes -= data.capacity();
+    data.clear();
+    return data;
+}
+
+size_t ImagePool::recycledDataCount() const
+{
+    auto const _l = std::lock_guard{recycledData_->lock};
+    return recycledData_->buffers.size();
+}
+
 shared_ptr<RasterizedImage const> ImagePool::rasterize(shared_ptr<Image const> _image,
                                                        ImageAlignment _alignmentPolicy,
                                                        ImageResize _resizePolicy,
@@ -116,7 +135,21 @@ void ImagePool::removeImage(Image* _image)
                          [&](Image const& p) { return &p == _image; }); i != images_.end())
     {
         onImageRemove_(_image);
+        auto data = move(i->data_);
         images_.erase(i);
+
+        auto const _l = std::lock_guard{recycledData_->lock};
+        if (images_.empty())
+        {
+            // Nothing is going to be replaced by a new image of similar size anymore.
+            recycledData_->buffers.clear();
+            recycledData_->bytes = 0;
+        }
+        else if (recycledData_->bytes + data.capacity() <= RecycledData::MaxBytes)
+        {
+            recycledData_->bytes += data.capacity();
+            recycledData_->buffers.emplace_back(move(data));
+        }
     }
 }
 
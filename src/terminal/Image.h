@@ -24,6 +24,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace terminal {
@@ -72,9 +73,11 @@ class Image {
     constexpr int height() const noexcept { return size_.height; }
 
   private:
+    friend class ImagePool; // recycles data_ once the image is removed
+
     Id const id_;
     ImageFormat const format_;
-    Data const data_;
+    Data data_;
     crispy::Size const size_;
 };
 
@@ -209,6 +212,12 @@ class ImagePool {
     /// Creates an RGBA image of given size in pixels.
     std::shared_ptr<Image const> create(ImageFormat _format, crispy::Size _pixelSize, Image::Data&& _data);
 
+    /// @returns an empty pixel buffer to construct a new image's data in, reusing the memory
+    ///          of a previously removed image if available.
+    ///
+    /// Memory of removed images is only kept while other images are still alive.
+    Image::Data acquireData();
+
     /// Rasterizes an Image.
     std::shared_ptr<RasterizedImage const> rasterize(std::shared_ptr<Image const> _image,
                                                      ImageAlignment _alignmentPolicy,
@@ -226,6 +235,7 @@ class ImagePool {
     size_t imageCount() const noexcept { return images_.size(); }
     size_t rasterizedImageCount() const noexcept { return rasterizedImages_.size(); }
     size_t namedImageCount() const noexcept { return namedImages_.size(); }
+    size_t recycledDataCount() const;
 
   private:
     void removeImage(Image* _image);                        //!< Removes given image from pool.
@@ -237,6 +247,17 @@ class ImagePool {
     std::list<RasterizedImage> rasterizedImages_;                       //!< pool of rasterized images
     std::map<std::string, std::shared_ptr<Image const>> namedImages_;   //!< keeps mapping from name to raw image
     OnImageRemove const onImageRemove_;                                 //!< Callback to be invoked when image gets removed from pool.
+
+    // Images may be removed from within the render thread, when it drops the last reference.
+    // (held indirectly to keep the pool movable)
+    // Kept buffers are bounded in total bytes, and released altogether once no image is left.
+    struct RecycledData {
+        static constexpr size_t MaxBytes = 4 * 1024 * 1024;
+        std::mutex lock;
+        std::vector<Image::Data> buffers;
+        size_t bytes = 0; // total capacity of buffers
+    };
+    std::unique_ptr<RecycledData> recycledData_ = std::make_unique<RecycledData>(); //!< data of removed images, to be reused
 };
 
 } // end namespace
@@ -0,0 +1,67 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Image.h>
+#include <catch2/catch.hpp>
+
+using crispy::Size;
+using namespace terminal;
+
+TEST_CASE("ImagePool.acquireData", "[image]")
+{
+    auto pool = ImagePool{};
+    CHECK(pool.acquireData().empty());
+
+    auto data = pool.acquireData();
+    data.resize(4 * 4 * 4, 0xFF);
+    auto const pixels = data.data();
+
+    auto image = pool.create(ImageFormat::RGBA, Size{4, 4}, std::move(data));
+    REQUIRE(image);
+    CHECK(image->data().data() == pixels); // moved, not copied
+    CHECK(pool.recycledDataCount() == 0);
+
+    // e.g. the next frame of a sixel animation
+    auto const nextImage = pool.create(ImageFormat::RGBA, Size{1, 1}, Image::Data(4, 0xFF));
+
+    image.reset();
+    CHECK(pool.imageCount() == 1);
+    CHECK(pool.recycledDataCount() == 1);
+
+    // The next image reuses the memory of the removed one.
+    auto const recycled = pool.acquireData();
+    CHECK(recycled.empty());
+    CHECK(recycled.capacity() >= 4 * 4 * 4);
+    CHECK(recycled.data() == pixels);
+    CHECK(pool.recycledDataCount() == 0);
+}
+
+TEST_CASE("ImagePool.acquireData.bounds", "[image]")
+{
+    auto pool = ImagePool{};
+    auto keptImage = pool.create(ImageFormat::RGBA, Size{1, 1}, Image::Data(4, 0xFF));
+
+    // Larger than all recycled data may be in total.
+    auto image = pool.create(ImageFormat::RGBA, Size{1024, 1025}, Image::Data(1024 * 1025 * 4, 0xFF));
+    image.reset();
+    CHECK(pool.recycledDataCount() == 0);
+
+    image = pool.create(ImageFormat::RGBA, Size{4, 4}, Image::Data(4 * 4 * 4, 0xFF));
+    image.reset();
+    CHECK(pool.recycledDataCount() == 1);
+
+    // Removing the last image releases whatever is kept.
+    keptImage.reset();
+    CHECK(pool.imageCount() == 0);
+    CHECK(pool.recycledDataCount() == 0);
+}
@@ -20,6 +20,23 @@
 
 #include <unicode/utf8.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIBTERMINAL_PARSER_SSE2 1
+#include <immintrin.h>
+#endif
+
+// AVX2 is used if the build targets it, or otherwise if the CPU supports it at runtime.
+#if defined(__AVX2__)
+#define LIBTERMINAL_PARSER_AVX2 1
+#elif defined(LIBTERMINAL_PARSER_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define LIBTERMINAL_PARSER_AVX2 1
+#define LIBTERMINAL_PARSER_AVX2_DISPATCH 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include <array>
 #include <cctype>
 #include <cstdio>
@@ -32,6 +49,87 @@ namespace terminal::parser {
 
 using namespace std;
 
+namespace {
+    inline unsigned countTrailingZeros(uint32_t _value) noexcept
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, _value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(_value));
+#endif
+    }
+}
+
+namespace {
+    // As signed bytes, exactly the characters 0x20 to 0x7F are greater than 0x1F.
+
+    /// Continues the printable run of [@p _begin, @p _end) at @p _input.
+    size_t printableRunLengthFrom(uint8_t const* _begin, uint8_t const* _input, uint8_t const* _end) noexcept
+    {
+        auto input = _input;
+
+#if defined(LIBTERMINAL_PARSER_SSE2)
+        auto const threshold = _mm_set1_epi8(0x1F);
+        while (_end - input >= 16)
+        {
+            auto const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input));
+            auto const mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, threshold)));
+            if (mask != 0xFFFFu)
+                return static_cast<size_t>(input - _begin) + countTrailingZeros(~mask);
+            input += 16;
+        }
+#endif
+
+        while (input != _end && 0x20 <= *input && *input <= 0x7F)
+            ++input;
+
+        return static_cast<size_t>(input - _begin);
+    }
+
+#if defined(LIBTERMINAL_PARSER_AVX2)
+#if defined(LIBTERMINAL_PARSER_AVX2_DISPATCH)
+    __attribute__((target("avx2")))
+#endif
+    size_t printableRunLengthAVX2(uint8_t const* _begin, uint8_t const* _end) noexcept
+    {
+        auto input = _begin;
+        auto const threshold = _mm256_set1_epi8(0x1F);
+        while (_end - input >= 32)
+        {
+            auto const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input));
+            auto const mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(chunk, threshold)));
+            if (mask != 0xFFFFFFFFu)
+                return static_cast<size_t>(input - _begin) + countTrailingZeros(~mask);
+            input += 32;
+        }
+        return printableRunLengthFrom(_begin, input, _end);
+    }
+#endif
+
+#if defined(LIBTERMINAL_PARSER_AVX2_DISPATCH)
+    // Evaluated during static initialization, which may precede the CPU feature detection otherwise.
+    bool const cpuSupportsAVX2 = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+#endif
+}
+
+size_t printableRunLength(uint8_t const* _begin, uint8_t const* _end) noexcept
+{
+#if defined(LIBTERMINAL_PARSER_AVX2_DISPATCH)
+    if (cpuSupportsAVX2)
+        return printableRunLengthAVX2(_begin, _end);
+    return printableRunLengthFrom(_begin, _begin, _end);
+#elif defined(LIBTERMINAL_PARSER_AVX2)
+    return printableRunLengthAVX2(_begin, _end);
+#else
+    return printableRunLengthFrom(_begin, _begin, _end);
+#endif
+}
+
 using Transition = pair<State, State>;
 using Range = ParserTable::Range;
 using RangeSet = std::vector<Range>;
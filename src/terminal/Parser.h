@@ -21,6 +21,7 @@
 
 #include <unicode/utf8.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <functional>
@@ -704,6 +705,10 @@ constexpr ParserTable ParserTable::get() // {{{
     return t;
 } // }}}
 
+/// @returns the number of leading bytes in [_begin, _end) that are US-ASCII characters
+///          in the range 0x20 to 0x7F, which are all printed as-is in ground state.
+size_t printableRunLength(uint8_t const* _begin, uint8_t const* _end) noexcept;
+
 /**
  * Terminal Parser.
  *
@@ -756,8 +761,33 @@ inline void Parser::parseFragment(iterator _begin, iterator _end)
 {
     static constexpr char32_t ReplacementCharacter {0xFFFD};
 
-    for (auto const current : crispy::range(_begin, _end))
+    auto input = _begin;
+    while (input != _end)
     {
+        // Plain text is printed in runs rather than character by character.
+        if (state_ == State::Ground && utf8DecoderState_.expectedLength == 0)
+        {
+            if (auto const count = printableRunLength(input, _end); count != 0)
+            {
+                eventListener_.printRun(std::string_view(reinterpret_cast<char const*>(input), count));
+                input += count;
+                continue;
+            }
+        }
+        else if (state_ == State::DCS_PassThrough && utf8DecoderState_.expectedLength == 0)
+        {
+            // So is the data of device control strings, such as sixel images (DEL is ignored there).
+            auto const run = printableRunLength(input, _end);
+            auto const count = static_cast<size_t>(std::distance(input, std::find(input, input + run, 0x7F)));
+            if (count != 0)
+            {
+                eventListener_.putRun(std::string_view(reinterpret_cast<char const*>(input), count));
+                input += count;
+                continue;
+            }
+        }
+
+        auto const current = *input++;
 #if 0
         std::visit(
             overloaded{
@@ -39,6 +39,18 @@ class ParserEvents {
      */
     virtual void print(char32_t _text) = 0;
 
+    /**
+     * Prints a run of US-ASCII characters in the range 0x20 to 0x7F at once.
+     *
+     * This is equivalent to invoking print() for each of the characters,
+     * which is what the default implementation does.
+     */
+    virtual void printRun(std::string_view _chars)
+    {
+        for (char const ch : _chars)
+            print(static_cast<char32_t>(ch));
+    }
+
     /**
      * The C0 or C1 control function should be executed, which may have any one of a variety of
      * effects, including changing the cursor position, suspending or resuming communications or
@@ -133,6 +145,19 @@ class ParserEvents {
      */
     virtual void put(char32_t _char) = 0;
 
+    /**
+     * Passes a run of US-ASCII characters (0x20 .. 0x7E) from the data string part of a device
+     * control string to the handler.
+     *
+     * This is equivalent to invoking put() for each of the characters,
+     * which is what the default implementation does.
+     */
+    virtual void putRun(std::string_view _chars)
+    {
+        for (char const ch : _chars)
+            put(static_cast<char32_t>(ch));
+    }
+
     /**
      * When a device control string is terminated by ST, CAN, SUB or ESC, this action calls the
      * previously selected handler function with an “end of data” parameter. This allows the
@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <string>
+#include <string_view>
 
 namespace terminal {
 
@@ -17,6 +18,14 @@ class ParserExtension
 
     virtual void start() = 0;
     virtual void pass(char32_t _char) = 0;
+
+    /// Passes a run of US-ASCII characters, equivalent to passing them one by one.
+    virtual void pass(std::string_view _chars)
+    {
+        for (char const ch : _chars)
+            pass(static_cast<char32_t>(ch));
+    }
+
     virtual void finalize() = 0;
 };
 
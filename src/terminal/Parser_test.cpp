@@ -21,8 +21,14 @@ class MockParserEvents : public terminal::BasicParserEvents {
   public:
     std::vector<char32_t> text;
 
+
     void error(string_view const& _msg) override { INFO(fmt::format("Parser error received. {}", _msg)); }
     void print(char32_t _ch) override { text.push_back(_ch); }
+    void put(char32_t _ch) override { data.push_back(_ch); }
+    void putRun(string_view _chars) override { data.insert(data.end(), _chars.begin(), _chars.end()); runs++; }
+
+    std::vector<char32_t> data;
+    int runs = 0;
 };
 
 TEST_CASE("Parser.utf8_single", "[Parser]")
@@ -36,3 +42,51 @@ TEST_CASE("Parser.utf8_single", "[Parser]")
     CHECK(0xF6 == static_cast<unsigned>(textListener.text.at(0)));
 }
 
+
+TEST_CASE("Parser.printableRunLength", "[Parser]")
+{
+    auto const runLength = [](string_view _text) {
+        auto const data = reinterpret_cast<uint8_t const*>(_text.data());
+        return parser::printableRunLength(data, data + _text.size());
+    };
+
+    CHECK(runLength("") == 0);
+    CHECK(runLength("\033[m") == 0);
+    CHECK(runLength("Hello\r\n") == 5);
+    CHECK(runLength("Hello, World \x7F") == 14);
+    CHECK(runLength("some text that spans multiple vector widths\033[m") == 43);
+    CHECK(runLength("some text that spans multiple vector widths \xC3\xB6") == 44);
+
+    // Every position of a run ending within and beyond each vector width.
+    for (size_t length = 0; length <= 100; ++length)
+    {
+        auto const text = string(length, 'x') + '\n' + string(50, 'y');
+        CHECK(runLength(text) == length);
+        CHECK(runLength(string_view(text).substr(0, length)) == length);
+    }
+}
+
+TEST_CASE("Parser.printRun", "[Parser]")
+{
+    MockParserEvents textListener;
+    auto p = parser::Parser(textListener);
+
+    // Runs continue to be printed across escape sequences and non-ASCII characters.
+    p.parseFragment("some text that spans multiple vector widths\033[1m\xC3\xB6!");
+
+    auto const expected = U"some text that spans multiple vector widthsö!"sv;
+    CHECK(u32string_view(textListener.text.data(), textListener.text.size()) == expected);
+}
+
+TEST_CASE("Parser.putRun", "[Parser]")
+{
+    MockParserEvents listener;
+    auto p = parser::Parser(listener);
+
+    // DEL is ignored within device control strings, other C0 characters are passed through.
+    p.parseFragment("\033Pq#0;2;0;0;0#0~~\x7F@@\r-\033\\");
+
+    auto const expected = U"#0;2;0;0;0#0~~@@\r-"sv;
+    CHECK(u32string_view(listener.data.data(), listener.data.size()) == expected);
+    CHECK(listener.runs == 3);
+}
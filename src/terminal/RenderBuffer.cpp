@@ -13,35 +13,26 @@
  */
 #include <terminal/RenderBuffer.h>
 
-#include <mutex>
-
 #include <fmt/format.h>
 
 namespace terminal {
 
-bool RenderDoubleBuffer::swapBuffers(std::chrono::steady_clock::time_point _now) noexcept
+RenderBufferRef RenderTripleBuffer::frontBuffer() const noexcept
 {
-    // If the terminal thread (writer) cannot try_lock (w/o wait time)
-    // the front buffer, it'll just flush back buffer instead of swapping
-    // buffers as the front buffer is apparently still in use by the
-    // renderer thread and we want to avoid render-thread imposed
-    // wait times in the terminal thread as much as possible.
-
-    if (!readerLock.try_lock())
-        return false;
+    if (readyIndex_.load(std::memory_order_relaxed) & FreshFlag)
+        frontIndex_ = readyIndex_.exchange(frontIndex_, std::memory_order_acq_rel) & IndexMask;
 
-    auto const _l = std::lock_guard<decltype(readerLock)>(readerLock, std::adopt_lock);
+    return RenderBufferRef{buffers[frontIndex_]};
+}
 
-    for (;;)
-    {
-        auto current = currentBackBufferIndex.load();
-        if (currentBackBufferIndex.compare_exchange_weak(current, (current + 1) % 2))
-            break;
-    }
+void RenderTripleBuffer::swapBuffers(std::chrono::steady_clock::time_point _now) noexcept
+{
+    // The reader never waits for the writer nor the other way around. Publishing always succeeds,
+    // possibly replacing a previously published frame that the reader did not acquire in time.
+    backIndex_ = readyIndex_.exchange(static_cast<uint8_t>(backIndex_ | FreshFlag), std::memory_order_acq_rel) & IndexMask;
 
     lastUpdate = _now;
     state = RenderBufferState::WaitingForRefresh;
-    return true;
 }
 
 }
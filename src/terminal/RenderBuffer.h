@@ -14,24 +14,36 @@
 #pragma once
 
 #include <terminal/Grid.h>
+#include <terminal/Image.h>
+
+#include <crispy/span.h>
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace terminal {
 
+/// A renderable cell.
+///
+/// Codepoints and images are not owned by the cell but by the RenderLine it belongs to,
+/// so that building a RenderLine does not allocate per cell.
 struct RenderCell
 {
-    std::u32string codepoints;
     Coordinate position;
     CellFlags flags;
     RGBColor foregroundColor;
     RGBColor backgroundColor;
     RGBColor decorationColor;
-    std::optional<ImageFragment> image;
+    uint32_t codepointOffset = 0;   // offset into RenderLine::codepoints
+    uint16_t codepointCount = 0;
+    uint16_t imageIndex = 0;        // 1-based index into RenderLine::images, or 0 if no image fragment
+    Coordinate imageOffset{};       // 0-based grid offset of the image fragment into the rasterized image
 };
 
 struct RenderCursor
@@ -42,43 +54,83 @@ struct RenderCursor
     int width;
 };
 
+/// Renderable cells of a single screen line.
+///
+/// The line's storage is reused when it is rebuilt, so that rebuilding only allocates
+/// when the line needs more storage than ever before.
+struct RenderLine
+{
+    std::vector<RenderCell> cells{};
+
+    /// Arena of the codepoints of all cells of this line.
+    std::u32string codepoints{};
+
+    /// Images referenced by the image fragments of this line's cells.
+    std::vector<std::shared_ptr<RasterizedImage const>> images{};
+
+    /// @returns the codepoints of the given cell of this line.
+    crispy::span<char32_t const> codepointsOf(RenderCell const& _cell) const noexcept
+    {
+        return crispy::span<char32_t const>(codepoints.data() + _cell.codepointOffset, _cell.codepointCount);
+    }
+
+    /// @returns the image the given cell of this line is a fragment of, or nullptr if none.
+    RasterizedImage const* imageOf(RenderCell const& _cell) const noexcept
+    {
+        return _cell.imageIndex ? images[_cell.imageIndex - 1u].get() : nullptr;
+    }
+
+    void clear() noexcept
+    {
+        cells.clear();
+        codepoints.clear();
+        images.clear();
+    }
+};
+
 struct RenderBuffer
 {
-    std::vector<RenderCell> screen{};
+    /// Renderable cells, one segment per screen line.
+    std::vector<RenderLine> lines{};
+
+    /// Screen lines whose segment is outdated and must be rebuilt before this buffer is presented again.
+    ///
+    /// Only the writer reads or modifies this, so it may be updated while this is the front buffer.
+    std::vector<bool> damagedLines{};
+
     std::optional<RenderCursor> cursor{};
 
-    void clear() { screen.clear(); cursor.reset(); }
+    /// Marks the segment of the screen line @p _row (1-based) as outdated.
+    void markDamaged(int _row) noexcept
+    {
+        if (auto const i = static_cast<size_t>(_row - 1); i < damagedLines.size())
+            damagedLines[i] = true;
+    }
+
+    /// Marks all segments of a screen with @p _lineCount lines as outdated.
+    void markAllDamaged(int _lineCount) { damagedLines.assign(static_cast<size_t>(_lineCount), true); }
+
+    void clear() { lines.clear(); damagedLines.clear(); cursor.reset(); }
 };
 
-/// Lock-guarded handle to a read-only RenderBuffer object.
+/// Handle to the read-only front RenderBuffer object.
+///
+/// The buffer remains valid and unmodified until the next frame is acquired by the reader.
 ///
 /// @see RenderBuffer
 struct RenderBufferRef
 {
     RenderBuffer const& buffer;
-    std::mutex& guard;
 
     RenderBuffer const& get() const noexcept { return buffer; }
-
-    RenderBufferRef(RenderBuffer const& _buf, std::mutex& _lock):
-        buffer{_buf}, guard{_lock}
-    {
-        guard.lock();
-    }
-
-    ~RenderBufferRef()
-    {
-        guard.unlock();
-    }
 };
 
-/// Reflects the current state of a RenderDoubleBuffer object.
+/// Reflects the current state of a RenderTripleBuffer object.
 ///
 enum class RenderBufferState
 {
     WaitingForRefresh,
-    RefreshBuffersAndTrySwap,
-    TrySwapBuffers
+    RefreshBuffersAndSwap,
 };
 
 constexpr std::string_view to_string(RenderBufferState _state) noexcept
@@ -86,35 +138,59 @@ constexpr std::string_view to_string(RenderBufferState _state) noexcept
     switch (_state)
     {
         case RenderBufferState::WaitingForRefresh: return "WaitingForRefresh";
-        case RenderBufferState::RefreshBuffersAndTrySwap: return "RefreshBuffersAndTrySwap";
-        case RenderBufferState::TrySwapBuffers: return "TrySwapBuffers";
+        case RenderBufferState::RefreshBuffersAndSwap: return "RefreshBuffersAndSwap";
     }
     return "INVALID";
 }
 
-struct RenderDoubleBuffer
+/// Hands off frames from the terminal (writer) thread to the render (reader) thread
+/// without either of them ever waiting for the other.
+///
+/// The writer builds a frame in the back buffer and publishes it by exchanging the back buffer
+/// with the ready buffer. The reader acquires the ready buffer by exchanging it with the front buffer,
+/// iff a frame has been published since it last did so. A published frame that has not been
+/// acquired yet is replaced by the next published frame (latest wins).
+struct RenderTripleBuffer
 {
-    std::mutex mutable readerLock;
-    std::atomic<size_t> currentBackBufferIndex = 0;
-    std::array<RenderBuffer, 2> buffers{};
+    std::array<RenderBuffer, 3> buffers{};
     std::atomic<RenderBufferState> state = RenderBufferState::WaitingForRefresh;
     std::chrono::steady_clock::time_point lastUpdate{};
 
-    RenderBuffer& backBuffer() noexcept { return buffers[currentBackBufferIndex]; }
+    /// @returns the buffer to build the next frame in. May only be invoked by the writer thread.
+    RenderBuffer& backBuffer() noexcept { return buffers[backIndex_]; }
 
-    RenderBufferRef frontBuffer() const
-    {
-        RenderBuffer const& frontBuffer = buffers.at((currentBackBufferIndex + 1) % 2);
-        return RenderBufferRef(frontBuffer, readerLock);
-    }
+    /// Acquires the most recently published frame. May only be invoked by the (single) reader thread.
+    RenderBufferRef frontBuffer() const noexcept;
 
     void clear()
     {
         backBuffer().clear();
     }
 
-    // Swaps front with back buffer. May only be invoked by the writer thread.
-    bool swapBuffers(std::chrono::steady_clock::time_point _now) noexcept;
+    /// Marks the segment of the screen line @p _row as outdated in all buffers.
+    void markDamaged(int _row) noexcept
+    {
+        for (RenderBuffer& buffer: buffers)
+            buffer.markDamaged(_row);
+    }
+
+    /// Marks all segments of a screen with @p _lineCount lines as outdated in all buffers.
+    void markAllDamaged(int _lineCount)
+    {
+        for (RenderBuffer& buffer: buffers)
+            buffer.markAllDamaged(_lineCount);
+    }
+
+    /// Publishes the back buffer as the most recent frame. May only be invoked by the writer thread.
+    void swapBuffers(std::chrono::steady_clock::time_point _now) noexcept;
+
+  private:
+    static constexpr uint8_t IndexMask = 0x03;
+    static constexpr uint8_t FreshFlag = 0x04; // set on readyIndex_ when published but not yet acquired
+
+    uint8_t backIndex_ = 0;
+    mutable uint8_t frontIndex_ = 1;
+    mutable std::atomic<uint8_t> readyIndex_ = 2;
 };
 
 } // end namespace
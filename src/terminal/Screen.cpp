@@ -27,7 +27,6 @@
 
 #include <unicode/emoji_segmenter.h>
 #include <unicode/word_segmenter.h>
-#include <unicode/grapheme_segmenter.h>
 #include <unicode/convert.h>
 #include <unicode/utf8.h>
 
@@ -65,6 +64,7 @@ using std::max;
 using std::min;
 using std::monostate;
 using std::next;
+using std::prev;
 using std::nullopt;
 using std::optional;
 using std::ostringstream;
@@ -417,6 +417,14 @@ void Screen::setMaxHistoryLineCount(optional<int> _maxHistoryLineCount)
     primaryGrid().setMaxHistoryLineCount(_maxHistoryLineCount);
 }
 
+void Screen::setHistoryDiskQuota(optional<size_t> _quota)
+{
+    if (_quota == historyDiskQuota())
+        return;
+
+    primaryGrid().setHistoryFile(_quota.has_value() ? HistoryFile::create(*_quota) : nullptr);
+}
+
 void Screen::resizeColumns(int _newColumnCount, bool _clear)
 {
     // DECCOLM / DECSCPP
@@ -560,17 +568,19 @@ void Screen::writeText(char32_t _char)
 
     char32_t const lastChar =
         consecutiveTextWrite && !lastColumn_->empty()
-            ? lastColumn_->codepoint(lastColumn_->codepointCount() - 1)
+            ? lastColumn_->codepoints(grid().clusters()).back()
             : char32_t{0};
 
     bool const insertToPrev =
-        lastChar && unicode::grapheme_segmenter::nonbreakable(lastChar, ch);
+        lastChar && graphemeNonbreakable(lastChar, ch);
 
     if (!insertToPrev)
         writeCharToCurrentAndAdvance(ch);
     else
     {
-        auto const extendedWidth = lastColumn_->appendCharacter(ch);
+        auto const extendedWidth = lastColumn_->appendCharacter(ch, grid().clusters());
+        grid().markDamaged(lastCursorPosition_.row, lastCursorPosition_.column,
+                           min(lastCursorPosition_.column + lastColumn_->width() - 1, size_.width));
 
         if (extendedWidth > 0)
             clearAndAdvance(extendedWidth);
@@ -579,18 +589,82 @@ void Screen::writeText(char32_t _char)
     sequencer_.resetInstructionCounter();
 }
 
+void Screen::writeText(std::string_view _chars)
+{
+    if (_chars.empty())
+        return;
+
+    // Only the first character may extend the grapheme cluster of the previously written one.
+    writeText(static_cast<char32_t>(_chars.front()));
+    _chars.remove_prefix(1);
+
+    if (!cursor_.charsets.isIdentity())
+    {
+        for (char const ch : _chars)
+            writeText(static_cast<char32_t>(ch));
+        return;
+    }
+
+    while (!_chars.empty())
+    {
+        if (wrapPending_ && cursor_.autoWrap)
+        {
+            linefeed(margin_.horizontal.from);
+            if (isModeEnabled(DECMode::TextReflow))
+                currentLine_->setWrapped(true);
+        }
+
+        bool const cursorInsideMargin = isModeEnabled(DECMode::LeftRightMargin) && isCursorInsideMargins();
+        auto const rightColumn = cursorInsideMargin ? margin_.horizontal.to : size_.width;
+        auto const n = min(rightColumn - cursor_.position.column + 1, static_cast<int>(_chars.size()));
+
+        auto cell = currentColumn_;
+        for (char const ch : _chars.substr(0, static_cast<size_t>(n)))
+        {
+            cell->setNarrowCharacter(ch != 0x7F ? static_cast<char32_t>(ch) : U' ');
+            cell->setAttributes(cursor_.graphicsRenditionId);
+#if defined(LIBTERMINAL_HYPERLINKS)
+            cell->setHyperlink(currentHyperlinkId_);
+#endif
+            ++cell;
+        }
+        _chars.remove_prefix(static_cast<size_t>(n));
+
+        auto const lastColumn = cursor_.position.column + n - 1;
+        grid().markDamaged(cursor_.position.row, cursor_.position.column, lastColumn);
+        lastColumn_ = prev(cell);
+        lastCursorPosition_ = Coordinate{cursor_.position.row, lastColumn};
+
+        if (lastColumn < rightColumn)
+        {
+            cursor_.position.column += n;
+            currentColumn_ = cell;
+        }
+        else
+        {
+            cursor_.position.column = lastColumn;
+            currentColumn_ = lastColumn_;
+            if (cursor_.autoWrap)
+                wrapPending_ = 1;
+        }
+    }
+}
+
 void Screen::writeCharToCurrentAndAdvance(char32_t _character)
 {
     Cell& cell = *currentColumn_;
     cell.setCharacter(_character);
-    cell.setAttributes(cursor_.graphicsRendition);
+    cell.setAttributes(cursor_.graphicsRenditionId);
 #if defined(LIBTERMINAL_HYPERLINKS)
-    cell.setHyperlink(currentHyperlink_);
+    cell.setHyperlink(currentHyperlinkId_);
 #endif
 
     lastColumn_ = currentColumn_;
     lastCursorPosition_ = cursor_.position;
 
+    grid().markDamaged(cursor_.position.row, cursor_.position.column,
+                       min(cursor_.position.column + cell.width() - 1, size_.width));
+
     bool const cursorInsideMargin = isModeEnabled(DECMode::LeftRightMargin) && isCursorInsideMargins();
     auto const cellsAvailable = cursorInsideMargin ? margin_.horizontal.to - cursor_.position.column
                                                    : size_.width - cursor_.position.column;
@@ -604,9 +678,9 @@ void Screen::writeCharToCurrentAndAdvance(char32_t _character)
         currentColumn_++;
         for (int i = 1; i < n; ++i)
 #if defined(LIBTERMINAL_HYPERLINKS)
-            (currentColumn_++)->reset(cursor_.graphicsRendition, currentHyperlink_);
+            (currentColumn_++)->reset(cursor_.graphicsRenditionId, currentHyperlinkId_);
 #else
-            (currentColumn_++)->reset(cursor_.graphicsRendition);
+            (currentColumn_++)->reset(cursor_.graphicsRenditionId);
 #endif
     }
     else if (cursor_.autoWrap)
@@ -624,12 +698,13 @@ void Screen::clearAndAdvance(int _offset)
     if (n == _offset)
     {
         assert(n > 0);
+        grid().markDamaged(cursor_.position.row, cursor_.position.column + 1, cursor_.position.column + n);
         cursor_.position.column += n;
         for (auto i = 0; i < n; ++i)
 #if defined(LIBTERMINAL_HYPERLINKS)
-            (currentColumn_++)->reset(cursor_.graphicsRendition, currentHyperlink_);
+            (currentColumn_++)->reset(cursor_.graphicsRenditionId, currentHyperlinkId_);
 #else
-            (currentColumn_++)->reset(cursor_.graphicsRendition);
+            (currentColumn_++)->reset(cursor_.graphicsRenditionId);
 #endif
     }
     else if (cursor_.autoWrap)
@@ -649,21 +724,22 @@ std::string Screen::screenshot(function<string(int)> const& _postLine) const
         for (int const col : crispy::times(1, size_.width))
         {
             Cell const& cell = at({row, col});
+            GraphicsAttributes const& attributes = this->attributes(cell);
 
-            if (cell.attributes().styles & CellFlags::Bold)
+            if (attributes.styles & CellFlags::Bold)
                 writer.sgr_add(GraphicsRendition::Bold);
             else
                 writer.sgr_add(GraphicsRendition::Normal);
 
             // TODO: other styles (such as underline, ...)?
 
-            writer.setForegroundColor(cell.attributes().foregroundColor);
-            writer.setBackgroundColor(cell.attributes().backgroundColor);
+            writer.setForegroundColor(attributes.foregroundColor);
+            writer.setBackgroundColor(attributes.backgroundColor);
 
             if (!cell.codepointCount())
                 writer.write(U' ');
             else
-                for (char32_t const ch : cell.codepoints())
+                for (char32_t const ch : cell.codepoints(grid().clusters()))
                     writer.write(ch);
         }
         writer.sgr_add(GraphicsRendition::Reset);
@@ -686,7 +762,7 @@ optional<int> Screen::findMarkerBackward(int _currentCursorLine) const
     _currentCursorLine = min(_currentCursorLine, historyLineCount() + size_.height);
 
     for (int i = _currentCursorLine - 1; i >= 0; --i)
-        if (grid().absoluteLineAt(i).marked())
+        if (grid().absoluteLineFlags(i) & Line::Flags::Marked)
             return {i};
 
     return nullopt;
@@ -698,7 +774,7 @@ optional<int> Screen::findMarkerForward(int _currentCursorLine) const
         return nullopt;
 
     for (int i = _currentCursorLine + 1; i < historyLineCount() + grid().screenSize().height; ++i)
-        if (grid().absoluteLineAt(i).marked())
+        if (grid().absoluteLineFlags(i) & Line::Flags::Marked)
             return {i};
 
     return nullopt;
@@ -769,9 +845,10 @@ void Screen::resetSoft()
     setLeftRightMargin(1, size().width); // DECRLM
 
 #if defined(LIBTERMINAL_HYPERLINKS)
-    currentHyperlink_ = {};
+    currentHyperlinkId_ = {};
 #endif
     colorPalette_ = defaultColorPalette_;
+    grid().markPageDamaged();
 
     // TODO: DECNKM (Numeric keypad)
     // TODO: DECSCA (Select character attribute)
@@ -793,7 +870,10 @@ void Screen::resetHard()
 
     clearAllTabs();
 
+    auto const historyDiskQuota = this->historyDiskQuota();
     grids_ = emptyGrids(size(), primaryGrid().maxHistoryLineCount());
+    if (historyDiskQuota.has_value())
+        primaryGrid().setHistoryFile(HistoryFile::create(*historyDiskQuota));
     activeGrid_ = &primaryGrid();
     moveCursorTo(Coordinate{1, 1});
 
@@ -806,7 +886,7 @@ void Screen::resetHard()
     };
 
 #if defined(LIBTERMINAL_HYPERLINKS)
-    currentHyperlink_ = {};
+    currentHyperlinkId_ = {};
 #endif
     colorPalette_ = defaultColorPalette_;
 
@@ -840,6 +920,9 @@ void Screen::setBuffer(ScreenType _type)
         }
         screenType_ = _type;
 
+        // The damage of the previously active grid has not been rendered yet.
+        grid().markPageDamaged();
+
         eventListener_.bufferChanged(_type);
     }
 }
@@ -868,13 +951,13 @@ void Screen::linefeed(int _newColumn)
 
 void Screen::scrollUp(int _n, Margin const& _margin)
 {
-    grid().scrollUp(_n, cursor().graphicsRendition, _margin);
+    grid().scrollUp(_n, cursor().graphicsRenditionId, _margin);
     updateCursorIterators();
 }
 
 void Screen::scrollDown(int _n, Margin const& _margin)
 {
-    grid().scrollDown(_n, cursor().graphicsRendition, _margin);
+    grid().scrollDown(_n, cursor().graphicsRenditionId, _margin);
     updateCursorIterators();
 }
 
@@ -902,9 +985,10 @@ string Screen::renderHistoryTextLine(int _lineNumberIntoHistory) const
     string line;
     line.reserve(size_.width);
 
-    for (Cell const& cell : grid().lineAt(1 - _lineNumberIntoHistory))
-        if (cell.codepointCount())
-            line += cell.toUtf8();
+    auto const& historyLine = grid().lineAt(1 - _lineNumberIntoHistory);
+    for (int column = 0; column < historyLine.size(); ++column)
+        if (Cell const& cell = historyLine.at(static_cast<size_t>(column)); cell.codepointCount())
+            line += cell.toUtf8(grid().clusters());
         else
             line += ' '; // fill character
 
@@ -1012,17 +1096,18 @@ void Screen::clearToEndOfScreen()
 {
 #if defined(LIBTERMINAL_HYPERLINKS)
     if (isAlternateScreen() && cursor_.position.row == 1 && cursor_.position.column == 1)
-        hyperlinks_.clear();
+        hyperlinks_.clearUserIds();
 #endif
 
     clearToEndOfLine();
+    grid().markDamaged(cursor_.position.row + 1, size_.height, 1, size_.width);
 
-    for_each(
+    std::for_each(
         LIBTERMINAL_EXECUTION_COMMA(par)
         next(currentLine_),
         end(grid().mainPage()),
         [&](Line& line) {
-            fill(begin(line), end(line), Cell{{}, cursor_.graphicsRendition});
+            fill(begin(line), end(line), Cell{{}, cursor_.graphicsRenditionId});
         }
     );
 }
@@ -1030,13 +1115,14 @@ void Screen::clearToEndOfScreen()
 void Screen::clearToBeginOfScreen()
 {
     clearToBeginOfLine();
+    grid().markDamaged(1, cursor_.position.row - 1, 1, size_.width);
 
-    for_each(
+    std::for_each(
         LIBTERMINAL_EXECUTION_COMMA(par)
         begin(grid().mainPage()),
         currentLine_,
         [&](Line& line) {
-            fill(begin(line), end(line), Cell{{}, cursor_.graphicsRendition});
+            fill(begin(line), end(line), Cell{{}, cursor_.graphicsRenditionId});
         }
     );
 }
@@ -1062,33 +1148,38 @@ void Screen::eraseCharacters(int _n)
     // It's not clear from the spec how to perform erase when inside margin and number of chars to be erased would go outside margins.
     // TODO: See what xterm does ;-)
     size_t const n = min(size_.width - realCursorPosition().column + 1, _n == 0 ? 1 : _n);
-    fill_n(currentColumn_, n, Cell{{}, cursor_.graphicsRendition});
+    grid().markDamaged(cursor_.position.row, cursor_.position.column,
+                       cursor_.position.column + static_cast<int>(n) - 1);
+    fill_n(currentColumn_, n, Cell{{}, cursor_.graphicsRenditionId});
 }
 
 void Screen::clearToEndOfLine()
 {
+    grid().markDamaged(cursor_.position.row, cursor_.position.column, size_.width);
     fill(
         currentColumn_,
         end(*currentLine_),
-        Cell{{}, cursor_.graphicsRendition}
+        Cell{{}, cursor_.graphicsRenditionId}
     );
 }
 
 void Screen::clearToBeginOfLine()
 {
+    grid().markDamaged(cursor_.position.row, 1, cursor_.position.column);
     fill(
         begin(*currentLine_),
         next(currentColumn_),
-        Cell{{}, cursor_.graphicsRendition}
+        Cell{{}, cursor_.graphicsRenditionId}
     );
 }
 
 void Screen::clearLine()
 {
+    grid().markDamaged(cursor_.position.row, 1, size_.width);
     fill(
         begin(*currentLine_),
         end(*currentLine_),
-        Cell{{}, cursor_.graphicsRendition}
+        Cell{{}, cursor_.graphicsRenditionId}
     );
 }
 
@@ -1114,6 +1205,8 @@ void Screen::insertChars(int _lineNo, int _n)
 {
     auto const n = min(_n, margin_.horizontal.to - cursorPosition().column + 1);
 
+    grid().markDamaged(_lineNo, realCursorPosition().column, margin_.horizontal.to);
+
     auto && line = grid().lineAt(_lineNo);
     auto column0 = next(begin(line), realCursorPosition().column - 1);
     auto column1 = next(begin(line), margin_.horizontal.to - n);
@@ -1131,7 +1224,7 @@ void Screen::insertChars(int _lineNo, int _n)
     fill_n(
         columnIteratorAt(begin(line), cursor_.position.column),
         n,
-        Cell{L' ', cursor_.graphicsRendition}
+        Cell{L' ', cursor_.graphicsRenditionId}
     );
 }
 
@@ -1181,6 +1274,9 @@ void Screen::copyArea(int _top, int _left, int _bottom, int _right, int _page,
             return std::tuple{0, +1, _right - _left + 1};
     }();
 
+    grid().markDamaged(_targetTop, min(_targetTop + _bottom - _top, size_.height),
+                       _targetLeft, min(_targetLeft + _right - _left, size_.width));
+
     auto const [y0, yInc, yEnd] = [&]() {
         if (_targetTop > _top) // moving down
             return std::tuple{_bottom - _top, -1, -1};
@@ -1209,6 +1305,8 @@ void Screen::eraseArea(int _top, int _left, int _bottom, int _right)
     if (_top > _bottom || _left > _right)
         return;
 
+    grid().markDamaged(_top, _bottom, _left, _right);
+
     for (int y = _top; y <= _bottom; ++y)
     {
         Line& line = grid().lineAt(y);
@@ -1229,6 +1327,8 @@ void Screen::fillArea(char32_t _ch, int _top, int _left, int _bottom, int _right
     if (!(32 <= _ch && _ch <= 126) && !(160 <= _ch && _ch <= 255))
         return;
 
+    grid().markDamaged(_top, _bottom, _left, _right);
+
     for (int y = _top; y <= _bottom; ++y)
     {
         Line& line = grid().lineAt(y);
@@ -1236,7 +1336,7 @@ void Screen::fillArea(char32_t _ch, int _top, int _left, int _bottom, int _right
         for (int x = _left; x <= _right; ++x)
         {
             Cell& cell = *column;
-            cell.reset(cursor().graphicsRendition);
+            cell.reset(cursor().graphicsRenditionId);
             cell.setCharacter(_ch);
             ++column;
         }
@@ -1265,6 +1365,8 @@ void Screen::deleteCharacters(int _n)
 
 void Screen::deleteChars(int _lineNo, int _n)
 {
+    grid().markDamaged(_lineNo, realCursorPosition().column, margin_.horizontal.to);
+
     auto line = next(begin(grid().mainPage()), _lineNo - 1);
     auto column = next(begin(*line), realCursorPosition().column - 1);
     auto rightMargin = next(begin(*line), margin_.horizontal.to);
@@ -1283,7 +1385,7 @@ void Screen::deleteChars(int _lineNo, int _n)
     fill(
         prev(rightMargin, n),
         rightMargin,
-        Cell{L' ', cursor_.graphicsRendition}
+        Cell{L' ', cursor_.graphicsRenditionId}
     );
 }
 void Screen::deleteColumns(int _n)
@@ -1320,22 +1422,31 @@ void Screen::hyperlink(string const& _id, string const& _uri)
 {
 #if defined(LIBTERMINAL_HYPERLINKS)
     if (_uri.empty())
-        currentHyperlink_ = nullptr;
+        currentHyperlinkId_ = 0;
     else if (_id.empty())
-        currentHyperlink_ = make_shared<HyperlinkInfo>(HyperlinkInfo{_id, _uri});
-    else if (auto i = hyperlinks_.find(_id); i != hyperlinks_.end())
-        currentHyperlink_ = i->second;
+        currentHyperlinkId_ = addHyperlink(make_shared<HyperlinkInfo>(HyperlinkInfo{_id, _uri}));
+    else if (auto const id = hyperlinks_.findByUserId(_id); id != 0)
+        currentHyperlinkId_ = id;
     else
+        currentHyperlinkId_ = addHyperlink(make_shared<HyperlinkInfo>(HyperlinkInfo{_id, _uri}));
+#endif
+}
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+HyperlinkId Screen::addHyperlink(HyperlinkRef _hyperlink)
+{
+    if (hyperlinks_.needsCollect())
     {
-        currentHyperlink_ = make_shared<HyperlinkInfo>(HyperlinkInfo{_id, _uri});
-        hyperlinks_[_id] = currentHyperlink_;
+        auto used = std::unordered_set<HyperlinkId>{};
+        for (Grid const& grid : grids_)
+            grid.markUsedHyperlinks(used);
+        used.insert(currentHyperlinkId_);
+        hyperlinks_.collect(used);
     }
-    // TODO:
-    // Care about eviction.
-    // Move hyperlink store into ScreenBuffer, so it gets reset upon every switch into
-    // alternate screen (not for main screen!)
-#endif
+
+    return hyperlinks_.add(move(_hyperlink));
 }
+#endif
 
 void Screen::moveCursorUp(int _n)
 {
@@ -1494,7 +1605,7 @@ void Screen::captureBuffer(int _lineCount, bool _logicalLines)
                 if (!cell.codepointCount())
                     writer.write(U' ');
                 else
-                    for (char32_t const ch : cell.codepoints())
+                    for (char32_t const ch : cell.codepoints(grid().clusters()))
                         writer.write(ch);
             }
             trimSpaceRight(capturedBuffer);
@@ -1604,16 +1715,19 @@ void Screen::forwardIndex()
 void Screen::setForegroundColor(Color const& _color)
 {
     cursor_.graphicsRendition.foregroundColor = _color;
+    updateGraphicsRenditionId();
 }
 
 void Screen::setBackgroundColor(Color const& _color)
 {
     cursor_.graphicsRendition.backgroundColor = _color;
+    updateGraphicsRenditionId();
 }
 
 void Screen::setUnderlineColor(Color const& _color)
 {
     cursor_.graphicsRendition.underlineColor = _color;
+    updateGraphicsRenditionId();
 }
 
 void Screen::setCursorStyle(CursorDisplay _display, CursorShape _shape)
@@ -1705,6 +1819,36 @@ void Screen::setGraphicsRendition(GraphicsRendition _rendition)
             cursor_.graphicsRendition.styles &= ~CellFlags::Overline;
             break;
     }
+
+    updateGraphicsRenditionId();
+}
+
+void Screen::updateGraphicsRenditionId()
+{
+    if (auto const id = graphicsAttributes_.tryIntern(cursor_.graphicsRendition); id.has_value())
+    {
+        cursor_.graphicsRenditionId = *id;
+        return;
+    }
+
+    collectGraphicsAttributes();
+
+    // If even after collecting, all Ids are in use, fall back to default attributes.
+    cursor_.graphicsRenditionId = graphicsAttributes_.tryIntern(cursor_.graphicsRendition).value_or(0);
+}
+
+void Screen::collectGraphicsAttributes()
+{
+    auto used = std::vector<bool>(graphicsAttributes_.size(), false);
+
+    for (Grid const& grid : grids_)
+        grid.markUsedAttributes(used);
+
+    used[cursor_.graphicsRenditionId] = true;
+    used[savedCursor_.graphicsRenditionId] = true;
+    used[savedPrimaryCursor_.graphicsRenditionId] = true;
+
+    graphicsAttributes_.collect(used);
 }
 
 void Screen::setMark()
@@ -1958,6 +2102,7 @@ void Screen::screenAlignmentPattern()
 
     // and moves the cursor to the home position
     moveCursorTo({1, 1});
+    grid().markPageDamaged();
 
     // fills the complete screen area with a test pattern
     crispy::for_each(
@@ -1968,7 +2113,7 @@ void Screen::screenAlignmentPattern()
                 LIBTERMINAL_EXECUTION_COMMA(par)
                 begin(line),
                 end(line),
-                Cell{'E', cursor_.graphicsRendition}
+                Cell{'E', cursor_.graphicsRenditionId}
             );
         }
     );
@@ -2057,16 +2202,21 @@ void Screen::renderImage(std::shared_ptr<Image const> const& _imageRef,
         cellPixelSize_
     );
 
+    auto const imageId = grid().insertImage(rasterizedImage);
+
     if (linesToBeRendered)
     {
+        grid().markDamaged(_topLeft.row, _topLeft.row + linesToBeRendered - 1,
+                           _topLeft.column, _topLeft.column + columnsToBeRendered - 1);
         crispy::for_each(
             LIBTERMINAL_EXECUTION_COMMA(par)
             Size{columnsToBeRendered, linesToBeRendered},
             [&](Point const& offset) {
                 [[maybe_unused]] Cell& cell = at(_topLeft + offset);
-                cell.setImage(ImageFragment{rasterizedImage, Coordinate(offset)});
 #if defined(LIBTERMINAL_HYPERLINKS)
-                cell.setHyperlink(currentHyperlink_);
+                cell.setImage(imageId, Coordinate(offset), currentHyperlinkId_);
+#else
+                cell.setImage(imageId, Coordinate(offset));
 #endif
             }
         );
@@ -2082,17 +2232,17 @@ void Screen::renderImage(std::shared_ptr<Image const> const& _imageRef,
         {
             linefeed();
             moveCursorForward(_topLeft.column);
+            grid().markDamaged(size_.height, 1, columnsToBeRendered);
             crispy::for_each(
                 LIBTERMINAL_EXECUTION_COMMA(par)
                 crispy::times(columnsToBeRendered),
                 [&](int columnOffset) {
                     [[maybe_unused]] Cell& cell = at(Coordinate{size_.height, columnOffset + 1});
-                    cell.setImage(ImageFragment{
-                        rasterizedImage,
-                        Coordinate{linesToBeRendered + lineOffset, columnOffset}
-                    });
+                    auto const fragmentOffset = Coordinate{linesToBeRendered + lineOffset, columnOffset};
 #if defined(LIBTERMINAL_HYPERLINKS)
-                    cell.setHyperlink(currentHyperlink_);
+                    cell.setImage(imageId, fragmentOffset, currentHyperlinkId_);
+#else
+                    cell.setImage(imageId, fragmentOffset);
 #endif
                 }
             );
@@ -2401,6 +2551,7 @@ void Screen::resetDynamicColor(DynamicColorName _name)
             colorPalette_.selectionBackground = defaultColorPalette_.selectionBackground;
             break;
     }
+    grid().markPageDamaged();
 }
 
 void Screen::setDynamicColor(DynamicColorName _name, RGBColor const& _value)
@@ -2429,6 +2580,7 @@ void Screen::setDynamicColor(DynamicColorName _name, RGBColor const& _value)
             colorPalette_.selectionBackground = _value;
             break;
     }
+    grid().markPageDamaged();
 }
 
 void Screen::dumpState()
@@ -116,6 +116,7 @@ struct Cursor
     bool originMode = false;
     bool visible = true;
     GraphicsAttributes graphicsRendition{};
+    GraphicsAttributesId graphicsRenditionId = 0; //!< graphicsRendition's Id in the Screen's GraphicsAttributesPool
     CharsetMapping charsets{};
     // TODO: selective erase attribute
     // TODO: SS2/SS3 states
@@ -181,6 +182,17 @@ class Screen : public capabilities::StaticDatabase {
     void setMaxHistoryLineCount(std::optional<int> _maxHistoryLineCount);
     std::optional<int> maxHistoryLineCount() const noexcept { return grid().maxHistoryLineCount(); }
 
+    /// Enables moving scrollback lines beyond the history limit into a memory-mapped file of
+    /// at most @p _quota bytes rather than deleting them, or disables it if @p _quota is not set.
+    void setHistoryDiskQuota(std::optional<size_t> _quota);
+
+    std::optional<size_t> historyDiskQuota() const noexcept
+    {
+        if (auto const* file = grids_[0].historyFile(); file)
+            return file->quota();
+        return std::nullopt;
+    }
+
     int historyLineCount() const noexcept { return grid().historyLineCount(); }
 
     /// Writes given data into the screen.
@@ -193,6 +205,12 @@ class Screen : public capabilities::StaticDatabase {
 
     void writeText(char32_t _char);
 
+    /// Writes a run of US-ASCII characters in the range 0x20 to 0x7F.
+    ///
+    /// This is equivalent to writeText() for each character, but fills the cells of each
+    /// line segment at once.
+    void writeText(std::string_view _chars);
+
     /// Renders the full screen by passing every grid cell to the callback.
     template <typename Renderer>
     void render(Renderer&& _render, std::optional<int> _scrollOffset = std::nullopt) const
@@ -200,6 +218,13 @@ class Screen : public capabilities::StaticDatabase {
         activeGrid_->render(std::forward<Renderer>(_render), _scrollOffset);
     }
 
+    /// Renders a single screen line by passing each of its cells to the callback.
+    template <typename Renderer>
+    void renderLine(Renderer&& _render, int _row, std::optional<int> _scrollOffset = std::nullopt) const
+    {
+        activeGrid_->renderLine(std::forward<Renderer>(_render), _row, _scrollOffset);
+    }
+
     /// Renders a single text line.
     std::string renderTextLine(int _row) const;
 
@@ -328,6 +353,9 @@ class Screen : public capabilities::StaticDatabase {
 
     std::shared_ptr<Image const> uploadImage(ImageFormat _format, crispy::Size _imageSize, Image::Data&& _pixmap);
 
+    /// @returns an empty pixel buffer to decode a new image into, see ImagePool::acquireData().
+    Image::Data acquireImageData() { return imagePool_.acquireData(); }
+
     /**
      * Renders an image onto the screen.
      *
@@ -466,8 +494,21 @@ class Screen : public capabilities::StaticDatabase {
     /// Gets a reference to the cell relative to screen origin (top left, 1:1).
     Cell& at(Coordinate const& _coord) noexcept { return grid().at(_coord); }
 
-    /// Gets a reference to the cell relative to screen origin (top left, 1:1).
-    Cell const& at(Coordinate const& _coord) const noexcept { return grid().at(_coord); }
+    /// @returns the cell relative to screen origin (top left, 1:1).
+    Cell at(Coordinate const& _coord) const { return grid().at(_coord); }
+
+    /// Pool of all graphics renditions referenced by the cells of both, primary and alternate screen.
+    GraphicsAttributesPool const& graphicsAttributes() const noexcept { return graphicsAttributes_; }
+
+    /// @returns the graphics rendition of the given cell.
+    GraphicsAttributes const& attributes(Cell const& _cell) const noexcept { return graphicsAttributes_.at(_cell.attributesId()); }
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+    /// @returns the hyperlink of the cell at the given coordinate, or nullptr if none.
+    HyperlinkRef hyperlinkAt(Coordinate const& _coord) const noexcept { return hyperlinks_.at(at(_coord).hyperlink()); }
+
+    HyperlinkStorage const& hyperlinks() const noexcept { return hyperlinks_; }
+#endif
 
     bool isPrimaryScreen() const noexcept { return activeGrid_ == &grids_[0]; }
     bool isAlternateScreen() const noexcept { return activeGrid_ == &grids_[1]; }
@@ -568,7 +609,7 @@ class Screen : public capabilities::StaticDatabase {
     Grid& backgroundGrid() noexcept { return isPrimaryScreen() ? alternateGrid() : primaryGrid(); }
 
     /// @returns true iff given absolute line number is wrapped, false otherwise.
-    bool lineWrapped(int _lineNumber) const { return activeGrid_->absoluteLineAt(_lineNumber).wrapped(); }
+    bool lineWrapped(int _lineNumber) const { return activeGrid_->absoluteLineFlags(_lineNumber) & Line::Flags::Wrapped; }
 
     int toAbsoluteLine(int _relativeLine) const noexcept { return activeGrid_->toAbsoluteLine(_relativeLine); }
     Coordinate toAbsolute(Coordinate _coord) const noexcept { return {activeGrid_->toAbsoluteLine(_coord.row), _coord.column}; }
@@ -595,11 +636,22 @@ class Screen : public capabilities::StaticDatabase {
     void writeCharToCurrentAndAdvance(char32_t _codepoint);
     void clearAndAdvance(int _offset);
 
+    /// Interns the cursor's current graphics rendition into the attributes pool.
+    void updateGraphicsRenditionId();
+
+    /// Releases all graphics attributes that are not referenced anymore.
+    void collectGraphicsAttributes();
+
+#if defined(LIBTERMINAL_HYPERLINKS)
+    /// Adds the given hyperlink, evicting unreferenced ones first if the storage is full.
+    HyperlinkId addHyperlink(HyperlinkRef _hyperlink);
+#endif
+
     void fail(std::string const& _message) const;
 
     void updateCursorIterators()
     {
-        currentLine_ = next(begin(grid().mainPage()), cursor_.position.row - 1);
+        currentLine_ = std::next(begin(grid().mainPage()), cursor_.position.row - 1);
         updateColumnIterator();
     }
 
@@ -651,6 +703,8 @@ class Screen : public capabilities::StaticDatabase {
     ColorPalette defaultColorPalette_;
     ColorPalette colorPalette_;
 
+    GraphicsAttributesPool graphicsAttributes_;
+
     int maxImageColorRegisters_;
     crispy::Size maxImageSize_;
     crispy::Size maxImageSizeLimit_;
@@ -701,8 +755,8 @@ class Screen : public capabilities::StaticDatabase {
     // Hyperlink related
     //
 #if defined(LIBTERMINAL_HYPERLINKS)
-    HyperlinkRef currentHyperlink_ = {};
-    std::unordered_map<std::string, HyperlinkRef> hyperlinks_; // TODO: use a deque<> instead, always push_back, lookup reverse, evict in front.
+    HyperlinkId currentHyperlinkId_ = 0;
+    HyperlinkStorage hyperlinks_;
 #endif
 
     // experimental features
@@ -744,12 +798,10 @@ namespace fmt // {{{
         auto format(terminal::Cell const& cell, FormatContext& ctx)
         {
             std::string codepoints;
-            for (auto const i : crispy::times(cell.codepointCount()))
-            {
-                if (i)
-                    codepoints += ", ";
-                codepoints += fmt::format("{:02X}", static_cast<unsigned>(cell.codepoint(i)));
-            }
+            if (cell.codepointCount())
+                codepoints = fmt::format("{:02X}", static_cast<unsigned>(cell.codepoint()));
+            if (cell.codepointCount() > 1)
+                codepoints += fmt::format(", +{}", cell.codepointCount() - 1);
             return format_to(ctx.out(), "(chars={}, width={})", codepoints, cell.width());
         }
     };
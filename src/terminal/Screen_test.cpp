@@ -145,13 +145,13 @@ TEST_CASE("AppendChar.emoji_exclamationmark", "[screen]")
 
     screen.write(U"\u2757"); // ❗
     // screen.write(U"\uFE0F");
-    CHECK(screen.at({1, 1}).attributes().backgroundColor == IndexedColor::Blue);
+    CHECK(screen.attributes(screen.at({1, 1})).backgroundColor == IndexedColor::Blue);
     CHECK(screen.at({1, 1}).width() == 2);
-    CHECK(screen.at({1, 2}).attributes().backgroundColor == IndexedColor::Blue);
+    CHECK(screen.attributes(screen.at({1, 2})).backgroundColor == IndexedColor::Blue);
     CHECK(screen.at({1, 2}).width() == 1);
 
     screen.write(U"M");
-    CHECK(screen.at({1, 3}).attributes().backgroundColor == IndexedColor::Blue);
+    CHECK(screen.attributes(screen.at({1, 3})).backgroundColor == IndexedColor::Blue);
 }
 
 TEST_CASE("AppendChar.emoji_VS16_fixed_width", "[screen]")
@@ -165,12 +165,12 @@ TEST_CASE("AppendChar.emoji_VS16_fixed_width", "[screen]")
 
     // double-width emoji with VS16
     auto const& c1 = screen.at({1, 1});
-    CHECK(c1.codepoints() == U"\u2139\uFE0F");
+    CHECK(c1.codepoints(screen.grid().clusters()) == U"\u2139\uFE0F");
     CHECK(c1.width() == 1); // XXX by default: do not change width (TODO: create test for optionally changing width by configuration)
 
     // character after the emoji
     auto const& c2 = screen.at({1, 2});
-    CHECK(c2.codepoints() == U"X");
+    CHECK(c2.codepoints(screen.grid().clusters()) == U"X");
     CHECK(c2.width() == 1);
 
     // character after the emoji
@@ -190,7 +190,7 @@ TEST_CASE("AppendChar.emoji_VS16_with_changing_width", "[screen]") // TODO
 
     // double-width emoji with VS16
     auto const& c1 = screen.write(1, 1);
-    CHECK(c1.codepoints() == U"\u2139\uFE0F");
+    CHECK(c1.codepoints(screen.grid().clusters()) == U"\u2139\uFE0F");
     CHECK(c1.width() == 2);
 
     // unused cell
@@ -200,7 +200,7 @@ TEST_CASE("AppendChar.emoji_VS16_with_changing_width", "[screen]") // TODO
 
     // character after the emoji
     auto const& c3 = screen.write(1, 3);
-    CHECK(c3.codepoints() == U"X");
+    CHECK(c3.codepoints(screen.grid().clusters()) == U"X");
     CHECK(c3.width() == 1);
 }
 #endif
@@ -225,7 +225,7 @@ TEST_CASE("AppendChar.emoji_family", "[screen]")
 
     // double-width emoji with VS16
     auto const& c1 = screen.at({1, 1});
-    CHECK(c1.codepoints() == U"\U0001F468\u200D\U0001F468\u200D\U0001F467");
+    CHECK(c1.codepoints(screen.grid().clusters()) == U"\U0001F468\u200D\U0001F468\u200D\U0001F467");
     CHECK(c1.width() == 2);
 
     // unused cell
@@ -235,7 +235,7 @@ TEST_CASE("AppendChar.emoji_family", "[screen]")
 
     // character after the emoji
     auto const& c3 = screen.at({1, 3});
-    CHECK(c3.codepoints() == U"X");
+    CHECK(c3.codepoints(screen.grid().clusters()) == U"X");
     CHECK(c3.width() == 1);
 }
 
@@ -251,7 +251,7 @@ TEST_CASE("AppendChar.emoji_zwj1", "[screen]")
     // TODO: provide native UTF-32 write function (not emulated through UTF-8 -> UTF-32...)
 
     auto const& c1 = screen.at({1, 1});
-    CHECK(c1.codepoints() == emoji);
+    CHECK(c1.codepoints(screen.grid().clusters()) == emoji);
     CHECK(c1.width() == 2);
 
     // other columns remain untouched
@@ -270,7 +270,7 @@ TEST_CASE("AppendChar.emoji_1", "[screen]")
     screen.write(U"\U0001F600");
 
     auto const& c1 = screen.at({1, 1});
-    CHECK(c1.codepoints() == U"\U0001F600");
+    CHECK(c1.codepoints(screen.grid().clusters()) == U"\U0001F600");
     CHECK(c1.width() == 2);
     REQUIRE(screen.cursorPosition() == Coordinate{1, 3});
 
@@ -280,12 +280,12 @@ TEST_CASE("AppendChar.emoji_1", "[screen]")
     screen.write("B");
     auto const& c2 = screen.at({1, 2});
     CHECK(c2.codepointCount() == 0);
-    CHECK(c2.codepoints().empty());
+    CHECK(c2.codepoints(screen.grid().clusters()).empty());
     CHECK(c2.width() == 1);
 
     auto const& c3 = screen.at({1, 3});
     CHECK(c3.codepointCount() == 1);
-    CHECK(c3.codepoint(0) == 'B');
+    CHECK(c3.codepoint() == 'B');
     CHECK(c3.width() == 1);
 }
 
@@ -1203,8 +1203,8 @@ TEST_CASE("MoveCursorTo", "[screen]")
             screen.moveCursorTo({1, 1});
             CHECK(Coordinate{1, 1} == screen.cursorPosition());
             CHECK(Coordinate{2, 2} == screen.realCursorPosition());
-            CHECK('7' == (char)screen.at({1 + (TopMargin - 1), 1 + (LeftMargin - 1)}).codepoint(0));
-            CHECK('I' == (char)screen.at({3 + (TopMargin - 1), 3 + (LeftMargin - 1)}).codepoint(0));
+            CHECK('7' == (char)screen.at({1 + (TopMargin - 1), 1 + (LeftMargin - 1)}).codepoint());
+            CHECK('I' == (char)screen.at({3 + (TopMargin - 1), 3 + (LeftMargin - 1)}).codepoint());
         }
     }
 }
@@ -1518,7 +1518,7 @@ TEST_CASE("CursorNextLine", "[screen]")
         screen.setTopBottomMargin(2, 4);
         screen.setMode(DECMode::Origin, true);
         screen.moveCursorTo({1, 2});
-        REQUIRE(screen.currentCell().toUtf8() == "8");
+        REQUIRE(screen.currentCell().toUtf8(screen.grid().clusters()) == "8");
 
         SECTION("normal-1") {
             screen.moveCursorToNextLine(1);
@@ -1771,6 +1771,36 @@ TEST_CASE("captureBuffer", "[screen]")
     }
 }
 
+TEST_CASE("captureBuffer.logical", "[screen]")
+{
+    auto screen = MockScreen{{5, 2}};
+
+    //           [...            history ...        ...][main page area]
+    screen.write("1234567890ABC\r\nDEFGH\r\nIJKLMNO\r\nPQ");
+    REQUIRE(screen.historyLineCount() == 5);
+
+    SECTION("lines: 1") {
+        screen.captureBuffer(1, true);
+        INFO(crispy::escape(screen.replyData));
+        CHECK(screen.replyData == "\033]314;PQ\n\033\\\033]314;\033\\");
+    }
+    SECTION("lines: 2") {
+        screen.captureBuffer(2, true);
+        INFO(crispy::escape(screen.replyData));
+        CHECK(screen.replyData == "\033]314;IJKLMNO\nPQ\n\033\\\033]314;\033\\");
+    }
+    SECTION("lines: 4") {
+        screen.captureBuffer(4, true);
+        INFO(crispy::escape(screen.replyData));
+        CHECK(screen.replyData == "\033]314;1234567890ABC\nDEFGH\nIJKLMNO\nPQ\n\033\\\033]314;\033\\");
+    }
+    SECTION("lines: 4 (+1 overflow)") {
+        screen.captureBuffer(5, true);
+        INFO(crispy::escape(screen.replyData));
+        CHECK(screen.replyData == "\033]314;1234567890ABC\nDEFGH\nIJKLMNO\nPQ\n\033\\\033]314;\033\\");
+    }
+}
+
 TEST_CASE("render into history", "[screen]")
 {
     auto screen = MockScreen{{5, 2}};
@@ -1785,7 +1815,7 @@ TEST_CASE("render into history", "[screen]")
     auto const renderer = [&](Coordinate const& pos, Cell const& cell) {
         auto const offset = (pos.row - 1) * (screen.size().width + 1)
                           + (pos.column - 1);
-        renderedText.at(offset) = static_cast<char>(cell.codepoint(0));
+        renderedText.at(offset) = static_cast<char>(cell.codepoint());
         if (pos.column == screen.size().width)
             renderedText.at(offset + 1) = '\n';
     };
@@ -2578,6 +2608,107 @@ TEST_CASE("DECCRA.Left.intersecting", "[screen]")
 }
 // }}}
 
+TEST_CASE("writeText.run", "[screen]")
+{
+    // Writing a run of text at once must be equivalent to writing it character by character.
+    auto constexpr text = "ABCDEFGHIJKLMNOPQRSTUVW\x7F"sv;
+    auto constexpr text32 = U"ABCDEFGHIJKLMNOPQRSTUVW\x7F"sv;
+
+    for (auto const setup : {""sv,                          // autowrap
+                             "\033[?7l"sv,                  // no autowrap
+                             "\033[?69h\033[2;4s\033[1;3H"sv, // left/right margins
+                             "\033(0"sv})                   // DEC special graphics
+    {
+        INFO(crispy::escape(setup));
+        auto runScreen = MockScreen{{5, 4}};
+        auto charScreen = MockScreen{{5, 4}};
+        runScreen.write(setup);
+        charScreen.write(setup);
+
+        runScreen.write(text);
+        charScreen.write(text32);
+
+        CHECK(runScreen.renderText() == charScreen.renderText());
+        CHECK(runScreen.cursorPosition() == charScreen.cursorPosition());
+        CHECK(runScreen.historyLineCount() == charScreen.historyLineCount());
+    }
+}
+
+TEST_CASE("damage", "[screen]")
+{
+    auto screen = MockScreen{{5, 3}};
+    CHECK(screen.grid().damaged());
+    screen.grid().clearDamage();
+    CHECK_FALSE(screen.grid().damaged());
+
+    SECTION("text") {
+        screen.write("\033[2;2HAB");
+        CHECK(screen.grid().damage(1).empty());
+        CHECK(screen.grid().damage(2).from == 2);
+        CHECK(screen.grid().damage(2).to == 3);
+        CHECK(screen.grid().damage(3).empty());
+    }
+
+    SECTION("EL") {
+        screen.write("\033[3;4H\033[K");
+        CHECK(screen.grid().damage(2).empty());
+        CHECK(screen.grid().damage(3).from == 4);
+        CHECK(screen.grid().damage(3).to == 5);
+    }
+
+    SECTION("ED") {
+        screen.write("\033[2;4H\033[1J");
+        CHECK(screen.grid().damage(1).from == 1);
+        CHECK(screen.grid().damage(1).to == 5);
+        CHECK(screen.grid().damage(2).from == 1);
+        CHECK(screen.grid().damage(2).to == 4);
+        CHECK(screen.grid().damage(3).empty());
+    }
+
+    SECTION("scroll") {
+        screen.write("\033[2;3r\033[3H\n");
+        CHECK(screen.grid().damage(1).empty());
+        CHECK(screen.grid().damage(2).from == 1);
+        CHECK(screen.grid().damage(2).to == 5);
+        CHECK(screen.grid().damage(3).from == 1);
+        CHECK(screen.grid().damage(3).to == 5);
+    }
+}
+
+TEST_CASE("Screen.frequentSequences", "[screen]")
+{
+    auto screen = MockScreen{Size{5, 3}};
+    screen.write("ABCDE\r\nFGHIJ\r\nKLMNO");
+
+    screen.write("\033[2;3H");
+    CHECK(screen.cursorPosition() == Coordinate{2, 3});
+
+    screen.write("\033[3;4;5H"); // too many parameters for CUP
+    CHECK(screen.cursorPosition() == Coordinate{2, 3});
+
+    screen.write("\033[1;38;2;10;20;30;48;5;200m");
+    CHECK(screen.cursor().graphicsRendition.foregroundColor == Color{RGBColor{10, 20, 30}});
+    CHECK(screen.cursor().graphicsRendition.backgroundColor == Color{static_cast<IndexedColor>(200)});
+    CHECK(screen.cursor().graphicsRendition.styles & CellFlags::Bold);
+
+    screen.write("\033[m");
+    CHECK(screen.cursor().graphicsRendition.foregroundColor == Color{DefaultColor()});
+
+    screen.write("\033[?2026h");
+    CHECK(screen.isModeEnabled(DECMode::BatchedRendering));
+    screen.write("\033[?2026l");
+    CHECK_FALSE(screen.isModeEnabled(DECMode::BatchedRendering));
+
+    screen.write("\033[0;1K"); // too many parameters for EL
+    CHECK(screen.renderTextLine(2) == "FGHIJ");
+    screen.write("\033[K");
+    CHECK(screen.renderTextLine(2) == "FG   ");
+
+    screen.write("\033[f\033[J");
+    CHECK(screen.cursorPosition() == Coordinate{1, 1});
+    CHECK(screen.renderTextLine(3) == "     ");
+}
+
 // TODO: SetForegroundColor
 // TODO: SetBackgroundColor
 // TODO: SetGraphicsRendition
@@ -2597,3 +2728,27 @@ TEST_CASE("DECCRA.Left.intersecting", "[screen]")
 // TODO: DeviceStatusReport
 // TODO: SendDeviceAttributes
 // TODO: SendTerminalId
+
+TEST_CASE("Screen.hyperlink.referenced_are_kept", "[screen]")
+{
+    auto screen = MockScreen{{4, 2}};
+    screen.setMaxHistoryLineCount(1000);
+
+    screen.write("\033]8;;https://first/\033\\X\033]8;;\033\\");
+    for (int i = 0; i < 301; ++i)
+        screen.write("\r\n");
+    REQUIRE(screen.historyLineCount() == 300);
+
+    // Overwriting the same cell over and over leaves all but the last hyperlink unreferenced.
+    for (int i = 0; i < 2000; ++i)
+        screen.write(fmt::format("\r\033]8;;https://{}/\033\\Y\033]8;;\033\\", i));
+    CHECK(screen.hyperlinks().size() <= 1024);
+
+    auto const first = screen.hyperlinkAt({1 - screen.historyLineCount(), 1});
+    REQUIRE(first != nullptr);
+    CHECK(first->uri == "https://first/");
+
+    auto const last = screen.hyperlinkAt({screen.cursorPosition().row, 1});
+    REQUIRE(last != nullptr);
+    CHECK(last->uri == "https://1999/");
+}
@@ -68,15 +68,15 @@ Selector::Selector(Mode _mode,
                    Coordinate _from) :
     Selector{
         _mode,
-        [screen = std::ref(_screen)](Coordinate _pos) -> Cell const* {
+        [screen = std::ref(_screen)](Coordinate _pos) -> std::optional<Cell> {
             assert(_pos.row >= 0 && "must be absolute coordinate");
             auto const& buffer = screen.get();
             // convert line number  from absolute line to relative line number.
             auto const row = _pos.row - buffer.historyLineCount() + 1;
             if (row <= buffer.size().height)
-                return &buffer.at({row, _pos.column});
+                return buffer.at({row, _pos.column});
             else
-                return nullptr;
+                return std::nullopt;
         },
         [screen = std::ref(_screen)](int _line) -> bool {
             return screen.get().lineWrapped(_line);
@@ -92,7 +92,7 @@ Selector::Selector(Mode _mode,
 Coordinate Selector::stretchedColumn(Coordinate _coord) const noexcept
 {
     Coordinate stretched = _coord;
-    if (Cell const* cell = at(_coord); cell && cell->width() > 1)
+    if (auto const cell = at(_coord); cell && cell->width() > 1)
     {
         // wide character
         stretched.column += cell->width() - 1;
@@ -101,7 +101,7 @@ Coordinate Selector::stretchedColumn(Coordinate _coord) const noexcept
 
     while (stretched.column < columnCount_)
     {
-        if (Cell const* cell = at(stretched); cell)
+        if (auto const cell = at(stretched); cell)
         {
             if (cell->empty())
                 stretched.column++;
@@ -175,8 +175,8 @@ bool Selector::extend(Coordinate const& _coord)
 void Selector::extendSelectionBackward()
 {
     auto const isWordDelimiterAt = [this](Coordinate const& _coord) -> bool {
-        Cell const* cell = at(_coord);
-        return !cell || cell->empty() || wordDelimiters_.find(cell->codepoint(0)) != wordDelimiters_.npos;
+        auto const cell = at(_coord);
+        return !cell || cell->empty() || wordDelimiters_.find(cell->codepoint()) != wordDelimiters_.npos;
     };
 
     auto last = to_;
@@ -210,8 +210,8 @@ void Selector::extendSelectionBackward()
 void Selector::extendSelectionForward()
 {
     auto const isWordDelimiterAt = [this](Coordinate const& _coord) -> bool {
-        Cell const* cell = at(_coord);
-        return !cell || cell->empty() || wordDelimiters_.find(cell->codepoint(0)) != wordDelimiters_.npos;
+        auto const cell = at(_coord);
+        return !cell || cell->empty() || wordDelimiters_.find(cell->codepoint()) != wordDelimiters_.npos;
     };
 
     auto last = to_;
@@ -250,6 +250,15 @@ void Selector::stop()
         state_ = State::Complete;
 }
 
+void Selector::applyLineShift(LineShift const& _shift)
+{
+    for (Coordinate* coord : {&start_, &from_, &to_})
+        if (coord->row >= _shift.line)
+            coord->row += _shift.delta;
+
+    totalRowCount_ += _shift.delta;
+}
+
 tuple<vector<Selector::Range>, Coordinate const, Coordinate const> prepare(Selector const& _selector)
 {
     vector<Selector::Range> result;
@@ -13,6 +13,7 @@
  */
 #pragma once
 
+#include <terminal/Grid.h>
 #include <terminal/InputGenerator.h>
 //#include <terminal/Screen.h>
 
@@ -22,13 +23,14 @@
 #include <fmt/format.h>
 
 #include <functional>
+#include <optional>
 #include <vector>
 #include <utility>
 
 namespace terminal {
 
 class Screen;
-class Cell;
+struct LineShift;
 
 /**
  * Selector API.
@@ -74,7 +76,7 @@ class Selector {
 
 
     enum class Mode { Linear, LinearWordWise, FullLine, Rectangular };
-	using GetCellAt = std::function<Cell const*(Coordinate)>;
+	using GetCellAt = std::function<std::optional<Cell>(Coordinate)>;
     using GetWrappedFlag = std::function<bool(int)>;
 
     Selector(Mode _mode,
@@ -104,6 +106,9 @@ class Selector {
     /// Marks the selection as completed.
     void stop();
 
+    /// Moves the selection along with the lines it refers to, whose absolute line numbers have shifted.
+    void applyLineShift(LineShift const& _shift);
+
     constexpr Coordinate const& from() const noexcept { return from_; }
     constexpr Coordinate const& to() const noexcept { return to_; }
 
@@ -159,7 +164,7 @@ class Selector {
     {
         for (auto const& range : selection())
             for (auto const col : crispy::times(range.fromColumn, range.length()))
-                if (Cell const* cell = at({range.line, col}); cell != nullptr)
+                if (auto const cell = at({range.line, col}); cell.has_value())
                     _render(Coordinate{range.line, col}, *cell);
     }
 
@@ -175,7 +180,7 @@ class Selector {
 		}
 	}
 
-	Cell const* at(Coordinate const& _pos) const { return getCellAt_(_pos); }
+	std::optional<Cell> at(Coordinate const& _pos) const { return getCellAt_(_pos); }
 
 	void extendSelectionBackward();
 	void extendSelectionForward();
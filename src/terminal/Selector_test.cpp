@@ -31,16 +31,19 @@ using namespace terminal;
 namespace
 {
     struct TextSelection {
+        explicit TextSelection(GraphemeClusterStore const& _clusters): clusters_{_clusters} {}
+
         string text;
 
         void operator()(Coordinate const& _pos, Cell const& _cell)
         {
             text += _pos.column < lastColumn_ ? "\n" : "";
-            text += _cell.toUtf8();
+            text += _cell.toUtf8(clusters_);
             lastColumn_ = _pos.column;
         }
 
       private:
+        GraphemeClusterStore const& clusters_;
         int lastColumn_ = 0;
     };
 }
@@ -70,7 +73,7 @@ TEST_CASE("Selector.Linear", "[selector]")
         CHECK(r1.toColumn == pos.column);
         CHECK(r1.length() == 1);
 
-        auto selectedText = TextSelection{};
+        auto selectedText = TextSelection{screen.grid().clusters()};
         selector.render(selectedText);
         CHECK(selectedText.text == "b");
     }
@@ -88,7 +91,7 @@ TEST_CASE("Selector.Linear", "[selector]")
         CHECK(r1.toColumn == 4);
         CHECK(r1.length() == 3);
 
-        auto selectedText = TextSelection{};
+        auto selectedText = TextSelection{screen.grid().clusters()};
         selector.render(selectedText);
         CHECK(selectedText.text == "b,c");
     }
@@ -113,7 +116,7 @@ TEST_CASE("Selector.Linear", "[selector]")
         CHECK(r2.toColumn == 4);
         CHECK(r2.length() == 4);
 
-        auto selectedText = TextSelection{};
+        auto selectedText = TextSelection{screen.grid().clusters()};
         selector.render(selectedText);
         CHECK(selectedText.text == "b,cdefg,hi\n1234");
     }
@@ -147,7 +150,7 @@ TEST_CASE("Selector.Linear", "[selector]")
         CHECK(r2.toColumn == 3);
         CHECK(r2.length() == 3);
 
-        auto selectedText = TextSelection{};
+        auto selectedText = TextSelection{screen.grid().clusters()};
         selector.render(selectedText);
         CHECK(selectedText.text == "fg,hi\n123");
     }
@@ -187,7 +190,7 @@ TEST_CASE("Selector.Linear", "[selector]")
         CHECK(r3.toColumn == 2);
         CHECK(r3.length() == 2);
 
-        auto selectedText = TextSelection{};
+        auto selectedText = TextSelection{screen.grid().clusters()};
         selector.render(selectedText);
         CHECK(selectedText.text == ",hi\n12345,67890\nfo");
     }
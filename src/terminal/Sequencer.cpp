@@ -249,6 +249,8 @@ namespace impl // {{{ some command generator helpers
                 case 4: // ":4:F:C:M:Y:K" (TODO)
                     break;
                 case 5: // ":5:P"
+                    if (_seq.subParameterCount(i) < 2)
+                        break;
                     if (auto const P = _seq.subparam(i, 1); P <= 255)
                     {
                         *pi = i + 1;
@@ -904,7 +906,7 @@ std::string Sequence::raw() const
         case FunctionCategory::OSC: sstr << "\033]"; break;
     }
 
-    if (parameterCount() > 1 || (parameterCount() == 1 && parameters_[0][0] != 0))
+    if (parameterCount() > 1 || (parameterCount() == 1 && param(0) != 0))
     {
         for (auto i = 0u; i < parameterCount(); ++i)
         {
@@ -937,35 +939,22 @@ string Sequence::text() const
     if (leaderSymbol_)
         sstr << ' ' << leaderSymbol_;
 
-    if (parameterCount() > 1 || (parameterCount() == 1 && parameters_[0][0] != 0))
+    if (parameterCount() > 1 || (parameterCount() == 1 && param(0) != 0))
     {
-        sstr << ' ' << accumulate(
-            begin(parameters_), end(parameters_), string{},
-            [](string const& a, auto const& p) -> string {
-                return !a.empty()
-                    ? fmt::format("{};{}",
-                            a,
-                            accumulate(
-                                begin(p), end(p),
-                                string{},
-                                [](string const& x, Sequence::Parameter y) -> string {
-                                    return !x.empty()
-                                        ? fmt::format("{}:{}", x, y)
-                                        : std::to_string(y);
-                                }
-                            )
-                        )
-                    : accumulate(
-                            begin(p), end(p),
-                            string{},
-                            [](string const& x, Sequence::Parameter y) -> string {
-                                return !x.empty()
-                                    ? fmt::format("{}:{}", x, y)
-                                    : std::to_string(y);
-                            }
-                        );
+        sstr << ' ';
+        for (size_t i = 0; i < parameterCount(); ++i)
+        {
+            if (i)
+                sstr << ';';
+
+            auto const values = parameters_[i];
+            for (auto k = values.begin(); k != values.end(); ++k)
+            {
+                if (k != values.begin())
+                    sstr << ':';
+                sstr << *k;
             }
-        );
+        }
     }
 
     if (!intermediateCharacters().empty())
@@ -1004,6 +993,13 @@ void Sequencer::print(char32_t _char)
     screen_.writeText(_char);
 }
 
+void Sequencer::printRun(std::string_view _chars)
+{
+    precedingGraphicCharacter_ = static_cast<char32_t>(_chars.back());
+    instructionCounter_++;
+    screen_.writeText(_chars);
+}
+
 void Sequencer::execute(char _controlCode)
 {
     executeControlFunction(_controlCode);
@@ -1027,17 +1023,15 @@ void Sequencer::collectLeader(char _leader)
 void Sequencer::param(char _char)
 {
     if (sequence_.parameters().empty())
-        sequence_.parameters().push_back({0});
+        sequence_.parameters().push(0);
 
     switch (_char)
     {
         case ';':
-            if (sequence_.parameters().size() < Sequence::MaxParameters)
-                sequence_.parameters().push_back({0});
+            sequence_.parameters().push(0);
             break;
         case ':':
-            if (sequence_.parameters().back().size() < Sequence::MaxParameters)
-                sequence_.parameters().back().push_back({0});
+            sequence_.parameters().pushSub(0);
             break;
         case '0':
         case '1':
@@ -1049,7 +1043,7 @@ void Sequencer::param(char _char)
         case '7':
         case '8':
         case '9':
-            sequence_.parameters().back().back() = sequence_.parameters().back().back() * 10 + (_char - U'0');
+            sequence_.parameters().appendDigit(_char - '0');
             break;
     }
 }
@@ -1065,7 +1059,8 @@ void Sequencer::dispatchCSI(char _finalChar)
 {
     sequence_.setCategory(FunctionCategory::CSI);
     sequence_.setFinalChar(_finalChar);
-    handleSequence();
+    if (!handleFrequentSequence())
+        handleSequence();
 }
 
 void Sequencer::startOSC()
@@ -1085,7 +1080,7 @@ void Sequencer::putOSC(char32_t _char)
 void Sequencer::dispatchOSC()
 {
     auto const [code, skipCount] = parseOSC(sequence_.intermediateCharacters());
-    sequence_.parameters().push_back({static_cast<Sequence::Parameter>(code)});
+    sequence_.parameters().push(static_cast<Sequence::Parameter>(code));
     sequence_.intermediateCharacters().erase(0, skipCount);
     handleSequence();
     sequence_.clear();
@@ -1131,6 +1126,12 @@ void Sequencer::put(char32_t _char)
         hookedParser_->pass(_char);
 }
 
+void Sequencer::putRun(std::string_view _chars)
+{
+    if (hookedParser_)
+        hookedParser_->pass(_chars);
+}
+
 void Sequencer::unhook()
 {
     if (hookedParser_)
@@ -1178,7 +1179,8 @@ unique_ptr<ParserExtension> Sequencer::hookSixel(Sequence const& _seq)
             : backgroundColor_,
         usePrivateColorRegisters_
             ? make_shared<SixelColorPalette>(maxImageRegisterCount_, clamp(maxImageRegisterCount_, 0, 16384))
-            : imageColorPalette_
+            : imageColorPalette_,
+        screen_.acquireImageData()
     );
 
     return make_unique<SixelParser>(
@@ -1330,31 +1332,72 @@ void Sequencer::handleSequence()
         debuglog(VTParserTag).write("Unknown VT sequence: {}", sequence_);
 }
 
-void Sequencer::flushBatchedSequences()
+/// Applies the control sequences that dominate the output of full screen applications
+/// (SGR, CUP, HVP, ED, EL, DECSM, DECRM) without looking up their FunctionDefinition first.
+///
+/// @returns false if the current sequence is none of those and must be handled by handleSequence().
+bool Sequencer::handleFrequentSequence()
 {
-    for (auto const& batchable : batchedSequences_)
+#if defined(LIBTERMINAL_LOG_TRACE)
+    if (crispy::logging_sink::for_debug().enabled())
+        return false;
+#endif
+
+    if (!sequence_.intermediateCharacters().empty())
+        return false;
+
+    auto const argc = sequence_.parameterCount();
+    auto result = ApplyResult::Ok;
+    switch (sequence_.leaderSymbol())
     {
-        if (holds_alternative<char32_t>(batchable))
-            print(get<char32_t>(batchable));
-        else if (holds_alternative<Sequence>(batchable))
-        {
-            auto const& seq = get<Sequence>(batchable);
-            if (FunctionDefinition const* spec = seq.functionDefinition(); spec != nullptr)
-                applyAndLog(*spec, seq);
-        }
-        else if (holds_alternative<SixelImage>(batchable))
-        {
-            auto const& si = get<SixelImage>(batchable);
-            screen_.sixelImage(si.size, Image::Data(si.rgba));
-        }
+        case 0:
+            switch (sequence_.finalChar())
+            {
+                case 'm':
+                    result = impl::dispatchSGR(sequence_, screen_);
+                    break;
+                case 'H':
+                case 'f':
+                    if (argc > 2)
+                        return false;
+                    screen_.moveCursorTo(Coordinate{sequence_.param_or(0, 1), sequence_.param_or(1, 1)});
+                    break;
+                case 'J':
+                    result = impl::ED(sequence_, screen_);
+                    break;
+                case 'K':
+                    if (argc > 1)
+                        return false;
+                    result = impl::EL(sequence_, screen_);
+                    break;
+                default:
+                    return false;
+            }
+            break;
+        case '?':
+            if (argc == 0 || (sequence_.finalChar() != 'h' && sequence_.finalChar() != 'l'))
+                return false;
+            for (size_t i = 0; i < argc; ++i)
+                result = max(result, impl::setModeDEC(sequence_, i, sequence_.finalChar() == 'h', screen_));
+            break;
+        default:
+            return false;
     }
-    batchedSequences_.clear();
+
+    instructionCounter_++;
+    log(result, sequence_);
+    screen_.verifyState();
+    return true;
 }
 
 void Sequencer::applyAndLog(FunctionDefinition const& _function, Sequence const& _seq)
 {
-    auto const result = apply(_function, _seq);
-    switch (result)
+    log(apply(_function, _seq), _seq);
+}
+
+void Sequencer::log(ApplyResult _result, Sequence const& _seq)
+{
+    switch (_result)
     {
         case ApplyResult::Invalid:
             debuglog(VTParserTag).write("Invalid VT sequence: {}", _seq);
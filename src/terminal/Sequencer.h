@@ -19,7 +19,9 @@
 #include <terminal/Functions.h>
 #include <terminal/SixelParser.h>
 #include <crispy/size.h>
+#include <crispy/span.h>
 
+#include <array>
 #include <cassert>
 #include <memory>
 #include <string>
@@ -430,15 +432,6 @@ enum class RequestStatusString {
     DECSNLS
 };
 
-/// DECSIXEL - Sixel Graphics Image.
-struct SixelImage { // TODO: this struct is only used internally in Sequencer, make it private
-    /// Size in pixels for this image
-    crispy::Size size;
-
-    /// RGBA buffer of the image to be rendered
-    Image::Data rgba;
-};
-
 inline std::string setDynamicColorValue(RGBColor const& color) // TODO: yet another helper. maybe SemanticsUtils static class?
 {
     auto const r = static_cast<unsigned>(static_cast<float>(color.red) / 255.0f * 0xFFFF);
@@ -457,11 +450,94 @@ enum class ApplyResult {
 /// Helps constructing VT functions as they're being parsed by the VT parser.
 class Sequence {
   public:
+    size_t constexpr static MaxParameters = 16;
+    size_t constexpr static MaxSubParameters = 8;
+    size_t constexpr static MaxParameterValues = 64;
+    size_t constexpr static MaxOscLength = 512;
+
     using Parameter = int;
-    using ParameterList = std::vector<std::vector<Parameter>>;
     using Intermediaries = std::string;
     using DataString = std::string;
 
+    /// Parameters of a sequence, stored inline so that collecting them never allocates.
+    ///
+    /// All values, sub-parameters included, are stored in one flat array, and each
+    /// parameter refers to its leading value by offset into that array.
+    /// Values beyond the capacity limits are dropped.
+    class ParameterList {
+      public:
+        size_t size() const noexcept { return count_; }
+        bool empty() const noexcept { return count_ == 0; }
+
+        /// @returns the value of the parameter at @p _index, followed by its sub-parameters.
+        crispy::span<Parameter const> operator[](size_t _index) const noexcept
+        {
+            return crispy::span<Parameter const>(values_.data() + offsets_[_index],
+                                                 values_.data() + endOffset(_index));
+        }
+
+        Parameter value(size_t _index) const noexcept { return values_[offsets_[_index]]; }
+
+        Parameter subValue(size_t _index, size_t _subIndex) const noexcept
+        {
+            return values_[offsets_[_index] + 1 + _subIndex];
+        }
+
+        size_t subParameterCount(size_t _index) const noexcept
+        {
+            return endOffset(_index) - offsets_[_index] - 1u;
+        }
+
+        void clear() noexcept
+        {
+            count_ = 0;
+            valueCount_ = 0;
+            overflow_ = false;
+        }
+
+        /// Starts a new parameter with the given value.
+        void push(Parameter _value) noexcept
+        {
+            overflow_ = count_ == MaxParameters || valueCount_ == MaxParameterValues;
+            if (!overflow_)
+            {
+                offsets_[count_++] = valueCount_;
+                values_[valueCount_++] = _value;
+            }
+        }
+
+        /// Appends a sub-parameter to the last parameter.
+        void pushSub(Parameter _value) noexcept
+        {
+            overflow_ = overflow_ || !count_ || subParameterCount(count_ - 1u) == MaxSubParameters
+                     || valueCount_ == MaxParameterValues;
+            if (!overflow_)
+                values_[valueCount_++] = _value;
+        }
+
+        /// Appends a decimal digit to the most recently pushed value,
+        /// unless that value has been dropped for exceeding the capacity.
+        void appendDigit(int _digit) noexcept
+        {
+            if (overflow_)
+                return;
+            assert(valueCount_ != 0);
+            values_[valueCount_ - 1u] = values_[valueCount_ - 1u] * 10 + _digit;
+        }
+
+      private:
+        size_t endOffset(size_t _index) const noexcept
+        {
+            return _index + 1u < count_ ? offsets_[_index + 1u] : valueCount_;
+        }
+
+        std::array<Parameter, MaxParameterValues> values_{};
+        std::array<uint8_t, MaxParameters> offsets_{};
+        uint8_t count_ = 0;
+        uint8_t valueCount_ = 0;
+        bool overflow_ = false; // the most recently pushed value has been dropped
+    };
+
   private:
     FunctionCategory category_;
     char leaderSymbol_ = 0;
@@ -471,18 +547,6 @@ class Sequence {
     DataString dataString_;
 
   public:
-    size_t constexpr static MaxParameters = 16;
-    size_t constexpr static MaxSubParameters = 8;
-    size_t constexpr static MaxOscLength = 512;
-
-    Sequence()
-    {
-        parameters_.resize(MaxParameters);
-        for (auto& param : parameters_)
-            param.reserve(MaxSubParameters);
-        parameters_.clear();
-    }
-
     // mutators
     //
     void clear()
@@ -521,7 +585,7 @@ class Sequence {
         switch (category_)
         {
             case FunctionCategory::OSC:
-                return FunctionSelector{category_, 0, parameters_[0][0], 0, 0};
+                return FunctionSelector{category_, 0, parameters_.value(0), 0, 0};
             default:
             {
                 // Only support CSI sequences with 0 or 1 intermediate characters.
@@ -537,17 +601,18 @@ class Sequence {
     // accessors
     //
     FunctionCategory category() const noexcept { return category_; }
+    char leaderSymbol() const noexcept { return leaderSymbol_; }
     Intermediaries const& intermediateCharacters() const noexcept { return intermediateCharacters_; }
     char finalChar() const noexcept { return finalChar_; }
 
     ParameterList const& parameters() const noexcept { return parameters_; }
     size_t parameterCount() const noexcept { return parameters_.size(); }
-    size_t subParameterCount(size_t _index) const noexcept { return parameters_[_index].size() - 1; }
+    size_t subParameterCount(size_t _index) const noexcept { return parameters_.subParameterCount(_index); }
 
     std::optional<Parameter> param_opt(size_t _index) const noexcept
     {
-        if (_index < parameters_.size() && parameters_[_index][0])
-            return {parameters_[_index][0]};
+        if (_index < parameters_.size() && parameters_.value(_index))
+            return {parameters_.value(_index)};
         else
             return std::nullopt;
     }
@@ -560,15 +625,14 @@ class Sequence {
     int param(size_t _index) const noexcept
     {
         assert(_index < parameters_.size());
-        assert(0 < parameters_[_index].size());
-        return parameters_[_index][0];
+        return parameters_.value(_index);
     }
 
     int subparam(size_t _index, size_t _subIndex) const noexcept
     {
         assert(_index < parameters_.size());
-        assert(_subIndex + 1 < parameters_[_index].size());
-        return parameters_[_index][_subIndex + 1];
+        assert(_subIndex < parameters_.subParameterCount(_index));
+        return parameters_.subValue(_index, _subIndex);
     }
 
     bool containsParameter(int _value) const noexcept
@@ -603,6 +667,7 @@ class Sequencer : public ParserEvents {
     //
     void error(std::string_view const& _errorString) override;
     void print(char32_t _text) override;
+    void printRun(std::string_view _chars) override;
     void execute(char _controlCode) override;
     void clear() override;
     void collect(char _char) override;
@@ -615,20 +680,21 @@ class Sequencer : public ParserEvents {
     void dispatchOSC() override;
     void hook(char _function) override;
     void put(char32_t _char) override;
+    void putRun(std::string_view _chars) override;
     void unhook() override;
 
   private:
     void executeControlFunction(char _c0);
     void handleSequence();
+    bool handleFrequentSequence();
 
     [[nodiscard]] std::unique_ptr<ParserExtension> hookSTP(Sequence const& _ctx);
     [[nodiscard]] std::unique_ptr<ParserExtension> hookSixel(Sequence const& _ctx);
     [[nodiscard]] std::unique_ptr<ParserExtension> hookDECRQSS(Sequence const& _ctx);
     [[nodiscard]] std::unique_ptr<ParserExtension> hookXTGETTCAP(Sequence const& /*_seq*/);
 
-    void flushBatchedSequences();
-
     void applyAndLog(FunctionDefinition const& _function, Sequence const& _context);
+    void log(ApplyResult _result, Sequence const& _context);
     ApplyResult apply(FunctionDefinition const& _function, Sequence const& _context);
 
     // private data
@@ -637,8 +703,6 @@ class Sequencer : public ParserEvents {
     Screen& screen_;
     char32_t precedingGraphicCharacter_ = {};
     int64_t instructionCounter_ = 0;
-    using Batchable = std::variant<char32_t, Sequence, SixelImage>;
-    std::vector<Batchable> batchedSequences_;
 
     std::unique_ptr<ParserExtension> hookedParser_;
     std::unique_ptr<SixelImageBuilder> sixelImageBuilder_;
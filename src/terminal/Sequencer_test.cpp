@@ -0,0 +1,112 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/Sequencer.h>
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <string_view>
+
+using namespace terminal;
+
+TEST_CASE("Sequence.parameters", "[Sequencer]")
+{
+    // CSI 1;38:2:10:20:30;4 m
+    auto seq = Sequence{};
+    seq.setCategory(FunctionCategory::CSI);
+    seq.setFinalChar('m');
+    auto& params = seq.parameters();
+    params.push(1);
+    params.push(3);
+    params.appendDigit(8);
+    for (int const value: {2, 10, 20, 30})
+        params.pushSub(value);
+    params.push(4);
+
+    REQUIRE(seq.parameterCount() == 3);
+    CHECK(seq.param(0) == 1);
+    CHECK(seq.subParameterCount(0) == 0);
+    CHECK(seq.param(1) == 38);
+    REQUIRE(seq.subParameterCount(1) == 4);
+    CHECK(seq.subparam(1, 0) == 2);
+    CHECK(seq.subparam(1, 3) == 30);
+    CHECK(seq.param(2) == 4);
+    CHECK(seq.subParameterCount(2) == 0);
+    CHECK(seq.text() == "CSI 1;38:2:10:20:30;4 m");
+
+    params.clear();
+    CHECK(seq.parameterCount() == 0);
+    params.push(7);
+    CHECK(seq.param(0) == 7);
+}
+
+TEST_CASE("Sequence.parameters.limits", "[Sequencer]")
+{
+    auto seq = Sequence{};
+    auto& params = seq.parameters();
+
+    for (size_t i = 0; i < Sequence::MaxParameters; ++i)
+        params.push(static_cast<int>(i));
+    for (size_t i = 0; i <= Sequence::MaxSubParameters; ++i)
+        params.pushSub(static_cast<int>(i));
+    CHECK(seq.subParameterCount(Sequence::MaxParameters - 1) == Sequence::MaxSubParameters);
+
+    // Sub-parameters of a dropped parameter are dropped along with it.
+    params.push(static_cast<int>(Sequence::MaxParameters));
+    params.pushSub(42);
+    CHECK(seq.parameterCount() == Sequence::MaxParameters);
+    CHECK(seq.param(Sequence::MaxParameters - 1) == static_cast<int>(Sequence::MaxParameters - 1));
+    CHECK(seq.subParameterCount(Sequence::MaxParameters - 1) == Sequence::MaxSubParameters);
+}
+
+TEST_CASE("Sequence.parameters.overflow", "[Sequencer]")
+{
+    // Feeds the parameter bytes the way Sequencer::param() does.
+    auto const feed = [](Sequence& _seq, std::string_view _text) {
+        auto& params = _seq.parameters();
+        params.push(0);
+        for (char const ch: _text)
+        {
+            if (ch == ';')
+                params.push(0);
+            else if (ch == ':')
+                params.pushSub(0);
+            else
+                params.appendDigit(ch - '0');
+        }
+    };
+
+    auto seq = Sequence{};
+
+    // CSI 10;11;...;27 m, two more parameters than fit.
+    auto text = std::string{};
+    for (int i = 0; i < static_cast<int>(Sequence::MaxParameters) + 2; ++i)
+        text += (i ? ";" : "") + std::to_string(10 + i);
+    feed(seq, text);
+
+    REQUIRE(seq.parameterCount() == Sequence::MaxParameters);
+    for (size_t i = 0; i < Sequence::MaxParameters; ++i)
+        CHECK(seq.param(i) == static_cast<int>(10 + i));
+
+    // CSI 38:10:11:...:19;42 m, one more sub-parameter than fits, followed by a parameter.
+    seq.parameters().clear();
+    text = "38";
+    for (int i = 0; i <= static_cast<int>(Sequence::MaxSubParameters); ++i)
+        text += ":" + std::to_string(10 + i);
+    feed(seq, text + ";42");
+
+    REQUIRE(seq.parameterCount() == 2);
+    REQUIRE(seq.subParameterCount(0) == Sequence::MaxSubParameters);
+    CHECK(seq.subparam(0, Sequence::MaxSubParameters - 1) == static_cast<int>(10 + Sequence::MaxSubParameters - 1));
+    CHECK(seq.param(1) == 42);
+}
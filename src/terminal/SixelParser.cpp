@@ -15,6 +15,8 @@
 #include <terminal/Coordinate.h>
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 
 using crispy::Size;
 using std::clamp;
@@ -27,21 +29,11 @@ namespace terminal {
 
 namespace
 {
-    constexpr bool isDigit(char32_t _value) noexcept
-    {
-        return _value >= '0' && _value <= '9';
-    }
-
     constexpr int toDigit(char32_t _value) noexcept
     {
         return static_cast<int>(_value) - '0';
     }
 
-    constexpr bool isSixel(char32_t _value) noexcept
-    {
-        return _value >= 63 && _value <= 126;
-    }
-
     constexpr int8_t toSixel(char32_t _value) noexcept
     {
         return static_cast<int8_t>(static_cast<int>(_value) - 63);
@@ -51,6 +43,90 @@ namespace
     {
         return RGBColor{r, g, b};
     }
+
+    enum class CharClass : uint8_t {
+        Ignore,
+        Digit,              // '0'..'9'
+        Separator,          // ';'
+        Sixel,              // '?'..'~'
+        ColorIntroducer,    // '#'
+        RepeatIntroducer,   // '!'
+        RasterIntroducer,   // '"'
+        CarriageReturn,     // '$'
+        NextLine,           // '-'
+    };
+    constexpr size_t CharClassCount = 9;
+
+    enum class Action : uint8_t {
+        None,
+        Digit,              // shifts in a digit into the current parameter
+        Separator,          // starts the next parameter
+        Render,             // renders a single sixel
+        RenderRepeated,     // renders a sixel as often as the repeat introducer's parameter says
+        Rewind,
+        Newline,
+    };
+
+    struct Transition {
+        SixelParser::State target;
+        Action action;
+        bool leave;         // whether the current state is left (and target entered) before the action
+    };
+
+    constexpr size_t StateCount = 5;
+
+    constexpr auto charClasses = []() constexpr {
+        auto table = std::array<CharClass, 0x80>{};
+        for (char32_t ch = '0'; ch <= '9'; ++ch)
+            table[ch] = CharClass::Digit;
+        for (char32_t ch = 63; ch <= 126; ++ch)
+            table[ch] = CharClass::Sixel;
+        table[';'] = CharClass::Separator;
+        table['#'] = CharClass::ColorIntroducer;
+        table['!'] = CharClass::RepeatIntroducer;
+        table['"'] = CharClass::RasterIntroducer;
+        table['$'] = CharClass::CarriageReturn;
+        table['-'] = CharClass::NextLine;
+        return table;
+    }();
+
+    constexpr auto transitions = []() constexpr {
+        using State = SixelParser::State;
+        auto table = std::array<std::array<Transition, CharClassCount>, StateCount>{};
+
+        // Characters that are not special to the current state terminate it.
+        for (size_t state = 0; state < StateCount; ++state)
+        {
+            auto const inGround = static_cast<State>(state) == State::Ground;
+            auto& t = table[state];
+            t[size_t(CharClass::Ignore)] = Transition{State::Ground, Action::None, !inGround};
+            t[size_t(CharClass::Digit)] = Transition{State::Ground, Action::None, !inGround};
+            t[size_t(CharClass::Separator)] = Transition{State::Ground, Action::None, !inGround};
+            t[size_t(CharClass::Sixel)] = Transition{State::Ground, Action::Render, !inGround};
+            t[size_t(CharClass::ColorIntroducer)] = Transition{State::ColorIntroducer, Action::None, true};
+            t[size_t(CharClass::RepeatIntroducer)] = Transition{State::RepeatIntroducer, Action::None, true};
+            t[size_t(CharClass::RasterIntroducer)] = Transition{State::RasterSettings, Action::None, true};
+            t[size_t(CharClass::CarriageReturn)] = Transition{State::Ground, Action::Rewind, true};
+            t[size_t(CharClass::NextLine)] = Transition{State::Ground, Action::Newline, true};
+        }
+
+        auto& repeat = table[size_t(State::RepeatIntroducer)];
+        repeat[size_t(CharClass::Digit)] = Transition{State::RepeatIntroducer, Action::Digit, false};
+        repeat[size_t(CharClass::Sixel)] = Transition{State::Ground, Action::RenderRepeated, true};
+
+        auto& color = table[size_t(State::ColorIntroducer)];
+        color[size_t(CharClass::Digit)] = Transition{State::ColorParam, Action::Digit, true};
+
+        auto& colorParam = table[size_t(State::ColorParam)];
+        colorParam[size_t(CharClass::Digit)] = Transition{State::ColorParam, Action::Digit, false};
+        colorParam[size_t(CharClass::Separator)] = Transition{State::ColorParam, Action::Separator, false};
+
+        auto& raster = table[size_t(State::RasterSettings)];
+        raster[size_t(CharClass::Digit)] = Transition{State::RasterSettings, Action::Digit, false};
+        raster[size_t(CharClass::Separator)] = Transition{State::RasterSettings, Action::Separator, false};
+
+        return table;
+    }();
 }
 
 // VT 340 default color palette (https://www.vt100.net/docs/vt3xx-gp/chapter2.html#S2.4)
@@ -126,87 +202,37 @@ SixelParser::SixelParser(Events& _events, OnFinalize _finalizer) :
 
 void SixelParser::parse(char32_t _value)
 {
-    switch (state_)
+    auto const charClass = _value < charClasses.size() ? charClasses[_value] : CharClass::Ignore;
+    auto const& transition = transitions[static_cast<size_t>(state_)][static_cast<size_t>(charClass)];
+
+    if (transition.leave)
+        transitionTo(transition.target);
+
+    switch (transition.action)
     {
-        case State::Ground:
-            fallback(_value);
+        case Action::None:
             break;
-
-        case State::RepeatIntroducer:
-            // '!' NUMBER BYTE
-            if (isDigit(_value))
-                paramShiftAndAddDigit(toDigit(_value));
-            else if (isSixel(_value))
-            {
-                auto const sixel = toSixel(_value);
-                for (int i = 0; i < params_[0]; ++i)
-                    events_.render(sixel);
-                transitionTo(State::Ground);
-            }
-            else
-                fallback(_value);
+        case Action::Digit:
+            paramShiftAndAddDigit(toDigit(_value));
             break;
-
-        case State::ColorIntroducer:
-            if (isDigit(_value))
-            {
-                paramShiftAndAddDigit(toDigit(_value));
-                transitionTo(State::ColorParam);
-            }
-            else
-                fallback(_value);
+        case Action::Separator:
+            params_.push_back(0);
             break;
-
-        case State::ColorParam:
-            if (isDigit(_value))
-                paramShiftAndAddDigit(toDigit(_value));
-            else if (_value == ';')
-                params_.push_back(0);
-            else
-                fallback(_value);
+        case Action::Render:
+            events_.render(toSixel(_value), 1);
             break;
-
-        case State::RasterSettings:
-            if (isDigit(_value))
-                paramShiftAndAddDigit(toDigit(_value));
-            else if (_value == ';')
-                params_.push_back(0);
-            else
-                fallback(_value);
+        case Action::RenderRepeated:
+            events_.render(toSixel(_value), params_[0]);
+            break;
+        case Action::Rewind:
+            events_.rewind();
+            break;
+        case Action::Newline:
+            events_.newline();
             break;
     }
 }
 
-void SixelParser::fallback(char32_t _value)
-{
-    if (_value == '#')
-        transitionTo(State::ColorIntroducer);
-    else if (_value == '!')
-        transitionTo(State::RepeatIntroducer);
-    else if (_value == '"')
-        transitionTo(State::RasterSettings);
-    else if (_value == '$')
-    {
-        transitionTo(State::Ground);
-        events_.rewind();
-    }
-    else if (_value == '-')
-    {
-        transitionTo(State::Ground);
-        events_.newline();
-    }
-    else
-    {
-        if (state_ != State::Ground)
-            transitionTo(State::Ground);
-
-        if (isSixel(_value))
-            events_.render(toSixel(_value));
-    }
-
-    // ignore any other input value
-}
-
 void SixelParser::done()
 {
     transitionTo(State::Ground); // this also ensures current state's leave action is invoked
@@ -303,6 +329,11 @@ void SixelParser::pass(char32_t _char)
     parse(_char);
 }
 
+void SixelParser::pass(std::string_view _chars)
+{
+    parseFragment(_chars);
+}
+
 void SixelParser::finalize()
 {
     done();
@@ -314,15 +345,17 @@ SixelImageBuilder::SixelImageBuilder(Size const& _maxSize,
                                      int _aspectVertical,
                                      int _aspectHorizontal,
                                      RGBAColor _backgroundColor,
-                                     std::shared_ptr<SixelColorPalette> _colorPalette) :
+                                     std::shared_ptr<SixelColorPalette> _colorPalette,
+                                     Buffer _buffer) :
     maxSize_{ _maxSize },
     colors_{ std::move(_colorPalette) },
     size_{ _maxSize },
-    buffer_(size_.width * size_.height * 4),
+    buffer_{ std::move(_buffer) },
     sixelCursor_{ 0, 0 },
     currentColor_{0},
     aspectRatio_{ _aspectVertical, _aspectHorizontal }
 {
+    buffer_.resize(static_cast<size_t>(size_.width * size_.height * 4));
     clear(_backgroundColor);
 }
 
@@ -349,18 +382,6 @@ RGBAColor SixelImageBuilder::at(Coordinate _coord) const noexcept
     return RGBAColor{color[0], color[1], color[2], color[3]};
 }
 
-void SixelImageBuilder::write(Coordinate const& _coord, RGBColor const& _value) noexcept
-{
-    if (_coord.row >= 0 && _coord.row < size_.height && _coord.column >= 0 && _coord.column < size_.width)
-    {
-        auto const base = _coord.row * size_.width * 4 + _coord.column * 4;
-        buffer_[base + 0] = _value.red;
-        buffer_[base + 1] = _value.green;
-        buffer_[base + 2] = _value.blue;
-        buffer_[base + 3] = 0xFF;
-    }
-}
-
 void SixelImageBuilder::setColor(int _index, RGBColor const& _color)
 {
     colors_->setColor(_index, _color);
@@ -394,23 +415,34 @@ void SixelImageBuilder::setRaster(int _pan, int _pad, Size const& _imageSize)
     buffer_.resize(size_.width * size_.height * 4);
 }
 
-void SixelImageBuilder::render(int8_t _sixel)
+void SixelImageBuilder::render(int8_t _sixel, int _count)
 {
     // TODO: respect aspect ratio!
     auto const x = sixelCursor_.column;
-    if (x < size_.width)
+    auto const count = min(_count, size_.width - x);
+    if (count <= 0)
+        return;
+
+    if (_sixel)
     {
+        auto const color = currentColor();
+        auto const pixel = std::array<uint8_t, 4>{color.red, color.green, color.blue, 0xFF};
         for (int i = 0; i < 6; ++i)
         {
             auto const y = sixelCursor_.row + i;
-            auto const pos = Coordinate{y, x};
-            auto const pin = 1 << i;
-            auto const pinned = (_sixel & pin) != 0;
-            if (pinned)
-                write(pos, currentColor());
+            if (y >= size_.height)
+                break;
+
+            if (_sixel & (1 << i))
+            {
+                auto p = &buffer_[static_cast<size_t>((y * size_.width + x) * 4)];
+                for (int k = 0; k < count; ++k, p += 4)
+                    std::memcpy(p, pixel.data(), pixel.size());
+            }
         }
-        sixelCursor_.column++;
     }
+
+    sixelCursor_.column += count;
 }
 
 }
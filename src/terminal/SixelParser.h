@@ -32,7 +32,8 @@ namespace terminal {
 /// Parses a sixel stream without any Sixel introducer CSI or ST to leave sixel mode,
 /// that must be done by the parent parser.
 ///
-/// TODO: make this parser O(1) with state table lookup tables, just like the VT parser.
+/// Each input character is classified and then mapped to its action and state transition
+/// by table lookup, just like in the VT parser.
 class SixelParser : public ParserExtension
 {
   public:
@@ -68,8 +69,9 @@ class SixelParser : public ParserExtension
         /// the upcoming pixel data.
         virtual void setRaster(int _pan, int _pad, crispy::Size const& _imageSize) = 0;
 
-        /// renders a given sixel at the current sixel-cursor position.
-        virtual void render(int8_t _sixel) = 0;
+        /// Renders the given sixel @p _count times, starting at the current sixel-cursor position
+        /// and advancing the sixel-cursor by as many pixels.
+        virtual void render(int8_t _sixel, int _count) = 0;
     };
 
     using OnFinalize = std::function<void()>;
@@ -90,8 +92,8 @@ class SixelParser : public ParserExtension
 
     void parseFragment(std::string_view _range)
     {
-        for (char32_t ch : _range)
-            parse(static_cast<char>(ch)); // XXX only used in unit tests
+        for (char const ch : _range)
+            parse(static_cast<char32_t>(ch));
     }
 
     void parse(char32_t _value);
@@ -107,6 +109,7 @@ class SixelParser : public ParserExtension
     // ParserExtension overrides
     void start() override;
     void pass(char32_t _char) override;
+    void pass(std::string_view _chars) override;
     void finalize() override;
 
   private:
@@ -148,7 +151,7 @@ class SixelColorPalette
 /// Sixel Image Builder API
 ///
 /// Implements the SixelParser::Events event listener to construct a Sixel image.
-class SixelImageBuilder : public SixelParser::Events
+class SixelImageBuilder final : public SixelParser::Events
 {
   public:
     using Buffer = std::vector<uint8_t>;
@@ -157,7 +160,8 @@ class SixelImageBuilder : public SixelParser::Events
                       int _aspectVertical,
                       int _aspectHorizontal,
                       RGBAColor _backgroundColor,
-                      std::shared_ptr<SixelColorPalette> _colorPalette);
+                      std::shared_ptr<SixelColorPalette> _colorPalette,
+                      Buffer _buffer = {});
 
     crispy::Size const& maxSize() const noexcept { return maxSize_; }
 
@@ -178,13 +182,10 @@ class SixelImageBuilder : public SixelParser::Events
     void rewind() override;
     void newline() override;
     void setRaster(int _pan, int _pad, crispy::Size const& _imageSize) override;
-    void render(int8_t _sixel) override;
+    void render(int8_t _sixel, int _count) override;
 
     Coordinate const& sixelCursor() const noexcept { return sixelCursor_; }
 
-  private:
-    void write(Coordinate const& _coord, RGBColor const& _value) noexcept;
-
   private:
     crispy::Size const maxSize_;
     std::shared_ptr<SixelColorPalette> colors_;
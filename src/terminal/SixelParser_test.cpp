@@ -221,6 +221,34 @@ TEST_CASE("SixelParser.rep", "[sixel]")
     }
 }
 
+TEST_CASE("SixelParser.rep_clipped", "[sixel]")
+{
+    auto constexpr defaultColor = RGBAColor{0, 0, 0, 0xFF};
+    auto constexpr pinColor = RGBColor{0x10, 0x20, 0x30};
+    auto ib = sixelImageBuilder(Size{4, 4}, defaultColor);
+    auto sp = SixelParser{ib};
+
+    ib.setColor(0, pinColor);
+
+    // The repeated sixel is cut off at the right and the bottom border.
+    sp.parseFragment("!1@!9~");
+
+    CHECK(ib.sixelCursor() == Coordinate{0, 4});
+
+    for (int x = 0; x < ib.size().width; ++x)
+    {
+        for (int y = 0; y < ib.size().height; ++y)
+        {
+            auto const& actualColor = ib.at(Coordinate{y, x});
+            auto const pinned = x == 0 ? y == 0 : true;
+            if (pinned)
+                CHECK(actualColor.rgb() == pinColor);
+            else
+                CHECK(actualColor == defaultColor);
+        }
+    }
+}
+
 TEST_CASE("SixelParser.setAndUseColor", "[sixel]")
 {
     auto constexpr pinColors = std::array<RGBAColor, 4> {
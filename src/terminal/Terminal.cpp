@@ -12,6 +12,7 @@
  * limitations under the License.
  */
 #include <terminal/Terminal.h>
+#include <terminal/TerminalScheduler.h>
 
 #include <terminal/ControlCode.h>
 #include <terminal/InputGenerator.h>
@@ -21,6 +22,7 @@
 #include <crispy/stdfs.h>
 #include <crispy/debuglog.h>
 
+#include <cassert>
 #include <chrono>
 #include <utility>
 
@@ -44,9 +46,9 @@ namespace // {{{ helpers
             value.pop_back();
     };
 
-    tuple<RGBColor, RGBColor> makeColors(ColorPalette const& _colorPalette, Cell const& _cell, bool _reverseVideo, bool _selected)
+    tuple<RGBColor, RGBColor> makeColors(ColorPalette const& _colorPalette, GraphicsAttributes const& _attributes, bool _reverseVideo, bool _selected)
     {
-        auto const [fg, bg] = _cell.attributes().makeColors(_colorPalette, _reverseVideo);
+        auto const [fg, bg] = _attributes.makeColors(_colorPalette, _reverseVideo);
         if (!_selected)
             return tuple{fg, bg};
 
@@ -105,7 +107,20 @@ Terminal::Terminal(Pty& _pty,
 
 Terminal::~Terminal()
 {
-    pty_.wakeupReader();
+    if (scheduler_)
+        scheduler_->remove(*this);
+    else if (ptyReader_ && ptyReader_->thread.joinable())
+    {
+        {
+            auto const _l = lock_guard{ptyReader_->lock};
+            ptyReader_->stopRequested = true;
+        }
+        ptyReader_->spaceAvailable.notify_one();
+        pty_.wakeupReader();
+        ptyReader_->thread.join();
+    }
+    else
+        pty_.wakeupReader();
 
     if (screenUpdateThread_)
         screenUpdateThread_->join();
@@ -113,9 +128,35 @@ Terminal::~Terminal()
 
 void Terminal::start()
 {
+    if (ptyReader_)
+        ptyReader_->thread = std::thread(&Terminal::ptyReaderLoop, this);
+
     screenUpdateThread_ = make_unique<std::thread>(bind(&Terminal::mainLoop, this));
 }
 
+void Terminal::start(TerminalScheduler& _scheduler)
+{
+    if (!ptyReader_)
+    {
+        scheduler_ = &_scheduler;
+        if (_scheduler.add(*this, pty_.readinessHandle()))
+            return;
+        scheduler_ = nullptr;
+    }
+
+    start();
+}
+
+void Terminal::setPtyReaderRingCapacity(size_t _capacity)
+{
+    assert(!screenUpdateThread_);
+
+    if (_capacity)
+        ptyReader_ = make_unique<PtyReader>(_capacity);
+    else
+        ptyReader_.reset();
+}
+
 void Terminal::setRefreshRate(double _refreshRate)
 {
     refreshInterval_ = std::chrono::milliseconds(static_cast<long long>(1000.0 / _refreshRate));
@@ -129,7 +170,7 @@ void Terminal::mainLoop()
         "Starting main loop with thread id {}",
         [&]() {
             stringstream sstr;
-            sstr << mainLoopThreadID_;
+            sstr << mainLoopThreadID_.load();
             return sstr.str();
         }()
     );
@@ -143,20 +184,44 @@ void Terminal::mainLoop()
     eventListener_.onClosed();
 }
 
+bool Terminal::processScheduledInput()
+{
+    mainLoopThreadID_ = this_thread::get_id();
+    return processInputOnce(std::chrono::milliseconds(0));
+}
+
+void Terminal::scheduledInputClosed()
+{
+    eventListener_.onClosed();
+}
+
 bool Terminal::processInputOnce()
 {
     auto const timeout =
-        renderBuffer_.state == RenderBufferState::WaitingForRefresh && !screenDirty_
+        reflowPending_ ? std::chrono::milliseconds(0)
+        : renderBuffer_.state == RenderBufferState::WaitingForRefresh && !screenDirty_
             ? std::chrono::seconds(4)
             : refreshInterval_ // std::chrono::seconds(0)
             ;
 
-    auto const n = pty_.read(readBuffer_.data(), readBuffer_.size(), timeout);
+    return processInputOnce(timeout);
+}
 
-    if (n > 0)
+bool Terminal::processInputOnce(std::chrono::milliseconds _timeout)
+{
+    // Parse everything read within this iteration before letting anyone know about the screen update,
+    // so that a flood of output results in a single render.
+    deferScreenUpdates_ = true;
+    auto const n = ptyReader_ ? processPtyReaderInput(_timeout) : processPtyInput(_timeout);
+    deferScreenUpdates_ = false;
+    if (screenUpdateDeferred_)
     {
-        writeToScreen(readBuffer_.data(), n);
+        screenUpdateDeferred_ = false;
+        eventListener_.screenUpdated();
+    }
 
+    if (n > 0)
+    {
         #if defined(LIBTERMINAL_PASSIVE_RENDER_BUFFER_UPDATE)
         auto const now = std::chrono::steady_clock::now();
         ensureFreshRenderBuffer(now);
@@ -172,24 +237,213 @@ bool Terminal::processInputOnce()
         return false;
     }
 
+    // Reflow the remaining history in between reading input, in order to keep resizing responsive.
+    if (reflowPending_)
+    {
+        auto const _l = lock_guard{*this};
+        reflowPending_ = reflowPendingLines();
+    }
+
     return true;
 }
 
+int Terminal::processPtyInput(std::chrono::milliseconds _timeout)
+{
+    auto n = pty_.read(readBuffer_.data(), readBuffer_.size(), _timeout);
+    if (n <= 0)
+        return n;
+
+    // Keep on reading whatever the application has written in the meantime, without waiting,
+    // until there is nothing left or the read budget of one refresh interval is spent.
+    auto const deadline = steady_clock::now() + refreshInterval_;
+    auto total = 0;
+    for (;;)
+    {
+        writeToScreen(readBuffer_.data(), static_cast<size_t>(n));
+        total += n;
+        adaptReadBufferSize(static_cast<size_t>(n));
+
+        if (steady_clock::now() >= deadline)
+            break;
+
+        n = pty_.read(readBuffer_.data(), readBuffer_.size(), std::chrono::milliseconds(0));
+        if (n <= 0)
+            break;
+    }
+
+    return total;
+}
+
+int Terminal::processPtyReaderInput(std::chrono::milliseconds _timeout)
+{
+    auto& reader = *ptyReader_;
+
+    if (reader.ring.empty())
+    {
+        auto lock = unique_lock{reader.lock};
+        reader.dataAvailable.wait_for(lock, _timeout, [&]() {
+            return reader.wakeupRequested || reader.closed || !reader.ring.empty();
+        });
+        reader.wakeupRequested = false;
+    }
+
+    // Read the closed flag before the ring, so that no data committed before closing gets lost.
+    auto const closed = reader.closed.load();
+    auto const window = reader.ring.read_window();
+
+    if (window.empty())
+    {
+        errno = closed ? reader.error : EAGAIN;
+        return -1;
+    }
+
+    auto const deadline = steady_clock::now() + refreshInterval_;
+    auto total = size_t{0};
+    for (auto slice = window; !slice.empty(); slice = reader.ring.read_window())
+    {
+        auto const n = min(slice.size(), readBuffer_.size());
+        writeToScreen(slice.begin(), n);
+        total += n;
+        adaptReadBufferSize(n);
+
+        reader.ring.consume(n);
+        {
+            auto const _l = lock_guard{reader.lock};
+            if (reader.producerWaiting)
+                reader.spaceAvailable.notify_one();
+        }
+
+        if (steady_clock::now() >= deadline)
+            break;
+    }
+
+    return static_cast<int>(total);
+}
+
+void Terminal::adaptReadBufferSize(size_t _lastReadSize)
+{
+    auto const minSize = static_cast<size_t>(ptyReadBufferSize_);
+    auto const maxSize = minSize * MaxReadBufferGrowth;
+
+    // A full read buffer suggests there is more pending, so read bigger chunks during floods
+    // and fall back to the configured size as soon as the output calms down again.
+    if (_lastReadSize == readBuffer_.size() && readBuffer_.size() < maxSize)
+        readBuffer_.resize(min(readBuffer_.size() * 2, maxSize));
+    else if (_lastReadSize < readBuffer_.size() / 4 && readBuffer_.size() > minSize)
+        readBuffer_.resize(max(readBuffer_.size() / 2, minSize));
+}
+
+void Terminal::ptyReaderLoop()
+{
+    auto& reader = *ptyReader_;
+
+    while (!reader.stopRequested)
+    {
+        auto window = reader.ring.write_window();
+        if (window.empty())
+        {
+            // Stop draining the PTY until the main loop has caught up, leaving it up to the
+            // kernel's PTY buffer to eventually block the writing application.
+            auto lock = unique_lock{reader.lock};
+            reader.producerWaiting = true;
+            reader.spaceAvailable.wait(lock, [&]() {
+                return reader.stopRequested || !reader.ring.full();
+            });
+            reader.producerWaiting = false;
+            continue;
+        }
+
+        auto const n = pty_.read(window.begin(), window.size(), std::chrono::seconds(4));
+
+        if (n > 0)
+            reader.ring.commit(static_cast<size_t>(n));
+        else if (n == 0 || errno == EINTR || errno == EAGAIN)
+            continue;
+        else
+        {
+            auto const error = errno;
+            debuglog(TerminalTag).write("PTY read failed. {}", strerror(error));
+            reader.error = error;
+            break;
+        }
+
+        // Lock once, so that the notification cannot slip in between the main loop
+        // testing its wait predicate and going to sleep.
+        { auto const _l = lock_guard{reader.lock}; }
+        reader.dataAvailable.notify_one();
+    }
+
+    if (!reader.error)
+        reader.error = ECANCELED;
+
+    {
+        auto const _l = lock_guard{reader.lock};
+        reader.closed = true;
+    }
+    reader.dataAvailable.notify_one();
+}
+
+bool Terminal::reflowPendingLines()
+{
+    auto constexpr ReflowChunkSize = 4096;
+
+    auto& grid = screen_.primaryGrid();
+    auto const shift = grid.reflowPendingLines(ReflowChunkSize);
+
+    if (screen_.isPrimaryScreen() && shift.delta != 0)
+    {
+        viewport_.applyLineShift(shift);
+        if (selector_)
+            selector_->applyLineShift(shift);
+    }
+
+    return grid.pendingReflowLineCount() != 0;
+}
+
+void Terminal::reflowPendingLinesWithin(int _line, int _count)
+{
+    auto& grid = screen_.primaryGrid();
+    while (auto const shift = grid.reflowPendingLinesWithin(_line, _count))
+    {
+        if (shift->delta != 0)
+        {
+            viewport_.applyLineShift(*shift);
+            if (selector_)
+                selector_->applyLineShift(*shift);
+        }
+    }
+}
+
 // {{{ RenderBuffer synchronization
 void Terminal::breakLoopAndRefreshRenderBuffer()
 {
     changes_++;
-    renderBuffer_.state = RenderBufferState::RefreshBuffersAndTrySwap;
+    renderBuffer_.state = RenderBufferState::RefreshBuffersAndSwap;
 
     if (this_thread::get_id() == mainLoopThreadID_)
         return;
 
-    pty_.wakeupReader();
+    wakeupMainLoop();
+}
+
+void Terminal::wakeupMainLoop()
+{
+    // With a PTY reader thread, the main loop waits on the reader's ring rather than on the PTY.
+    if (ptyReader_)
+    {
+        {
+            auto const _l = lock_guard{ptyReader_->lock};
+            ptyReader_->wakeupRequested = true;
+        }
+        ptyReader_->dataAvailable.notify_one();
+    }
+    else
+        pty_.wakeupReader();
 }
 
 bool Terminal::refreshRenderBuffer(std::chrono::steady_clock::time_point _now)
 {
-    renderBuffer_.state = RenderBufferState::RefreshBuffersAndTrySwap;
+    renderBuffer_.state = RenderBufferState::RefreshBuffersAndSwap;
     ensureFreshRenderBuffer(_now);
     return renderBuffer_.state == RenderBufferState::WaitingForRefresh;
 }
@@ -210,20 +464,14 @@ void Terminal::ensureFreshRenderBuffer(std::chrono::steady_clock::time_point _no
         case RenderBufferState::WaitingForRefresh:
             if (avoidRefresh || !screenDirty_)
                 break;
-            renderBuffer_.state = RenderBufferState::RefreshBuffersAndTrySwap;
+            renderBuffer_.state = RenderBufferState::RefreshBuffersAndSwap;
             [[fallthrough]];
-        case RenderBufferState::RefreshBuffersAndTrySwap:
+        case RenderBufferState::RefreshBuffersAndSwap:
             refreshRenderBuffer(renderBuffer_.backBuffer());
-            renderBuffer_.state = RenderBufferState::TrySwapBuffers;
-            [[fallthrough]];
-        case RenderBufferState::TrySwapBuffers:
-            #if !defined(LIBTERMINAL_PASSIVE_RENDER_BUFFER_UPDATE)
-                // We have been actively invoked by the render thread, so don't inform it about updates.
-                renderBuffer_.swapBuffers(_now);
-            #else
+            renderBuffer_.swapBuffers(_now);
+            #if defined(LIBTERMINAL_PASSIVE_RENDER_BUFFER_UPDATE)
                 // Passively invoked by the terminal thread, so do inform render thread about updates.
-                if (renderBuffer_.swapBuffers(_now))
-                    eventListener_.renderBufferUpdated();
+                eventListener_.renderBufferUpdated();
             #endif
             break;
     }
@@ -242,57 +490,142 @@ void Terminal::refreshRenderBuffer(RenderBuffer& _output)
 
     changes_.store(0);
 
-    if (renderHyperlinks)
+    auto const hoveredHyperlink = renderHyperlinks ? screen_.hyperlinkAt(currentMousePositionRel) : HyperlinkRef{};
+    if (hoveredHyperlink)
+        hoveredHyperlink->state = HyperlinkState::Hover; // TODO: Left-Ctrl pressed?
+
+    screenDirty_ = false;
+    updateRenderBufferDamage(hoveredHyperlink.get());
+
+    // Only the line segments that are outdated in this buffer are rebuilt, all others are reused.
+    _output.lines.resize(_output.damagedLines.size());
+    for (int row = 1; row <= static_cast<int>(_output.lines.size()); ++row)
     {
-        auto& cellAtMouse = screen_.at(currentMousePositionRel);
-        if (cellAtMouse.hyperlink())
-            cellAtMouse.hyperlink()->state = HyperlinkState::Hover; // TODO: Left-Ctrl pressed?
+        if (!_output.damagedLines[static_cast<size_t>(row - 1)])
+            continue;
+        _output.damagedLines[static_cast<size_t>(row - 1)] = false;
+        refreshRenderLine(_output.lines[static_cast<size_t>(row - 1)], row, baseLine, reverseVideo);
     }
 
+    if (hoveredHyperlink)
+        hoveredHyperlink->state = HyperlinkState::Inactive;
+
+    _output.cursor = renderCursor();
+}
+
+void Terminal::updateRenderBufferDamage(HyperlinkInfo const* _hoveredHyperlink)
+{
+    Grid& grid = screen_.grid();
+    auto const pageSize = screen_.size();
+
+    auto state = RenderState{};
+    state.pageSize = pageSize;
+    state.scrollOffset = viewport_.absoluteScrollOffset();
+    state.historyLineCount = screen_.historyLineCount();
+    state.reverseVideo = screen_.isModeEnabled(terminal::DECMode::ReverseVideo);
+    state.hoveredHyperlink = _hoveredHyperlink;
+    state.colorPalette = screen_.colorPalette();
+    if (isSelectionAvailable())
+    {
+        state.selectionMode = selector_->mode();
+        state.selectionFrom = selector_->from();
+        state.selectionTo = selector_->to();
+    }
+
+    // While scrolled into history, the viewport's lines are not tracked by the grid's damage,
+    // which only covers the main page.
+    auto const fullyDamaged = state.pageSize != renderState_.pageSize
+                           || state.scrollOffset != renderState_.scrollOffset
+                           || state.reverseVideo != renderState_.reverseVideo
+                           || state.hoveredHyperlink != renderState_.hoveredHyperlink
+                           || state.colorPalette != renderState_.colorPalette
+                           || (state.scrollOffset.has_value()
+                               && (state.historyLineCount != renderState_.historyLineCount || grid.damaged()));
+
+    if (fullyDamaged)
+        renderBuffer_.markAllDamaged(pageSize.height);
+    else
+    {
+        for (int row = 1; row <= pageSize.height; ++row)
+            if (!grid.damage(row).empty())
+                renderBuffer_.markDamaged(row);
+
+        // Selection changes only outdate the lines the old or new selection spans.
+        if (state.selectionMode != renderState_.selectionMode
+            || state.selectionFrom != renderState_.selectionFrom
+            || state.selectionTo != renderState_.selectionTo)
+        {
+            auto const baseLine = state.scrollOffset.value_or(state.historyLineCount);
+            auto const markLines = [&](RenderState const& _selection) {
+                if (!_selection.selectionMode.has_value())
+                    return;
+                auto const [top, bottom] = std::minmax(_selection.selectionFrom.row, _selection.selectionTo.row);
+                for (int line = std::max(top, baseLine); line <= std::min(bottom, baseLine + pageSize.height - 1); ++line)
+                    renderBuffer_.markDamaged(line - baseLine + 1);
+            };
+            markLines(state);
+            markLines(renderState_);
+        }
+    }
+
+    grid.clearDamage();
+    renderState_ = std::move(state);
+}
+
+void Terminal::refreshRenderLine(RenderLine& _output, int _row, int _baseLine, bool _reverseVideo)
+{
+    auto const& grid = screen_.grid();
+
     // {{{ void appendCell(pos, cell, fg, bg)
     auto const appendCell = [&](Coordinate const& _pos, Cell const& _cell,
                                 RGBColor fg, RGBColor bg)
     {
-        RenderCell cell;
+        RenderCell& cell = _output.cells.emplace_back();
         cell.backgroundColor = bg;
         cell.foregroundColor = fg;
-        cell.decorationColor = _cell.attributes().getUnderlineColor(screen_.colorPalette());
+        GraphicsAttributes const& attributes = screen_.attributes(_cell);
+        cell.decorationColor = attributes.getUnderlineColor(screen_.colorPalette());
         cell.position = _pos;
-        cell.flags = _cell.attributes().styles;
+        cell.flags = attributes.styles;
 
-        if (!_cell.codepoints().empty())
+        if (_cell.codepointCount() != 0)
         {
 #if defined(LIBTERMINAL_IMAGES)
-            assert(!_cell.imageFragment().has_value());
+            assert(!_cell.imageId());
 #endif
-            cell.codepoints = _cell.codepoints();
+            auto const codepoints = _cell.codepoints(grid.clusters());
+            cell.codepointOffset = static_cast<uint32_t>(_output.codepoints.size());
+            cell.codepointCount = static_cast<uint16_t>(codepoints.size());
+            _output.codepoints.append(codepoints);
         }
 #if defined(LIBTERMINAL_IMAGES)
-        else if (optional<ImageFragment> const& fragment = _cell.imageFragment(); fragment.has_value())
+        else if (_cell.imageId())
         {
-            assert(_cell.codepoints().empty());
             cell.flags |= CellFlags::Image; // TODO: this should already be there.
-            cell.image = _cell.imageFragment();
+
+            // Fragments of the same image are usually adjacent, so the image is referenced only once per run.
+            auto const& image = grid.images().at(_cell.imageId());
+            if (_output.images.empty() || _output.images.back() != image)
+                _output.images.emplace_back(image);
+            cell.imageIndex = static_cast<uint16_t>(_output.images.size());
+            cell.imageOffset = _cell.imageOffset();
         }
 #endif
 
-        if (_cell.hyperlink())
+        if (auto const hyperlink = screen_.hyperlinks().at(_cell.hyperlink()); hyperlink)
         {
-            auto const& color = _cell.hyperlink()->state == HyperlinkState::Hover
+            auto const& color = hyperlink->state == HyperlinkState::Hover
                                 ? screen_.colorPalette().hyperlinkDecoration.hover
                                 : screen_.colorPalette().hyperlinkDecoration.normal;
             // TODO(decoration): Move property into Terminal.
-            auto const decoration = _cell.hyperlink()->state == HyperlinkState::Hover
+            auto const decoration = hyperlink->state == HyperlinkState::Hover
                                     ? CellFlags::Underline          // TODO: decorationRenderer_.hyperlinkHover()
                                     : CellFlags::DottedUnderline;   // TODO: decorationRenderer_.hyperlinkNormal();
             cell.flags |= decoration; // toCellStyle(decoration);
             cell.decorationColor = color;
         }
-
-        _output.screen.emplace_back(std::move(cell));
     }; // }}}
 
-    screenDirty_ = false;
     _output.clear();
 
     enum class State {
@@ -301,30 +634,36 @@ void Terminal::refreshRenderBuffer(RenderBuffer& _output)
     };
     State state = State::Gap;
 
-    int lineNr = 1;
-    screen_.render(
+    // Consecutive cells mostly share the same graphics rendition,
+    // so colors are only resolved when the attribute Id (or selection state) changes.
+    struct {
+        std::optional<GraphicsAttributesId> attributesId;
+        bool selected = false;
+        RGBColor fg;
+        RGBColor bg;
+    } colors;
+
+    screen_.renderLine(
         [&](Coordinate const& _pos, Cell const& _cell) // mutable
         {
-            auto const absolutePos = Coordinate{baseLine + (_pos.row - 1), _pos.column};
+            auto const absolutePos = Coordinate{_baseLine + (_pos.row - 1), _pos.column};
             auto const selected = isSelectedAbsolute(absolutePos);
-            auto const [fg, bg] = makeColors(screen_.colorPalette(), _cell, reverseVideo, selected);
+            if (colors.attributesId != _cell.attributesId() || colors.selected != selected)
+            {
+                colors.attributesId = _cell.attributesId();
+                colors.selected = selected;
+                std::tie(colors.fg, colors.bg) = makeColors(screen_.colorPalette(), screen_.attributes(_cell), _reverseVideo, selected);
+            }
+            auto const fg = colors.fg;
+            auto const bg = colors.bg;
 
-            auto const cellEmpty = (_cell.codepoints().empty() || _cell.codepoints()[0] == 0x20)
+            auto const cellEmpty = (_cell.codepointCount() == 0 || _cell.codepoint() == 0x20)
 #if defined(LIBTERMINAL_IMAGES)
-                                && !_cell.imageFragment().has_value()
+                                && !_cell.imageId()
 #endif
                                 ;
             auto const customBackground = bg != screen_.colorPalette().defaultBackground;
 
-            bool isNewLine = false;
-            if (lineNr != _pos.row)
-            {
-                isNewLine = true;
-                lineNr = _pos.row;
-                if (!_output.screen.empty())
-                    _output.screen.back().flags |= CellFlags::CellSequenceEnd;
-            }
-
             switch (state)
             {
                 case State::Gap:
@@ -332,36 +671,27 @@ void Terminal::refreshRenderBuffer(RenderBuffer& _output)
                     {
                         state = State::Sequence;
                         appendCell(_pos, _cell, fg, bg);
-                        _output.screen.back().flags |= CellFlags::CellSequenceStart;
+                        _output.cells.back().flags |= CellFlags::CellSequenceStart;
                     }
                     break;
                 case State::Sequence:
                     if (cellEmpty && !customBackground)
                     {
-                        _output.screen.back().flags |= CellFlags::CellSequenceEnd;
+                        _output.cells.back().flags |= CellFlags::CellSequenceEnd;
                         state = State::Gap;
                     }
                     else
-                    {
                         appendCell(_pos, _cell, fg, bg);
-
-                        if (isNewLine)
-                            _output.screen.back().flags |= CellFlags::CellSequenceStart;
-                    }
                     break;
             }
         },
+        _row,
         viewport_.absoluteScrollOffset()
     );
 
-    if (renderHyperlinks)
-    {
-        auto& cellAtMouse = screen_.at(currentMousePositionRel);
-        if (cellAtMouse.hyperlink())
-            cellAtMouse.hyperlink()->state = HyperlinkState::Inactive;
-    }
-
-    _output.cursor = renderCursor();
+    // Sequences never span across lines.
+    if (!_output.cells.empty())
+        _output.cells.back().flags |= CellFlags::CellSequenceEnd;
 }
 
 optional<RenderCursor> Terminal::renderCursor()
@@ -374,7 +704,7 @@ optional<RenderCursor> Terminal::renderCursor()
 
     // TODO: check if CursorStyle has changed, and update render context accordingly.
 
-    Cell const& cursorCell = screen_.at(screen_.cursor().position);
+    Cell const cursorCell = screen_.at(screen_.cursor().position);
 
     auto const shape = screen_.focused() ? cursorShape()
                                          : CursorShape::Rectangle;
@@ -665,7 +995,7 @@ bool Terminal::updateCursorHoveringState()
         currentMousePosition_.column
     };
 
-    auto const newState = screen_.contains(currentMousePosition_) && screen_.at(relCursorPos).hyperlink();
+    auto const newState = screen_.contains(currentMousePosition_) && screen_.hyperlinkAt(relCursorPos);
     auto const oldState = hoveringHyperlink_.exchange(newState);
     return newState != oldState;
 }
@@ -688,6 +1018,20 @@ void Terminal::resizeScreen(Size _cells, optional<Size> _pixels)
         screen_.setCellPixelSize(*_pixels / _cells);
 
     pty_.resizeScreen(_cells, _pixels);
+
+    // History lines in view (plus a page above and below) are reflowed right away,
+    // the rest is left to the main loop.
+    auto const& grid = screen_.primaryGrid();
+    if (screen_.isPrimaryScreen() && viewport_.absoluteScrollOffset().has_value())
+    {
+        auto const margin = _cells.height;
+        reflowPendingLinesWithin(*viewport_.absoluteScrollOffset() - margin, margin);
+        reflowPendingLinesWithin(*viewport_.absoluteScrollOffset(), _cells.height + margin);
+    }
+
+    reflowPending_ = grid.pendingReflowLineCount() != 0;
+    if (reflowPending_)
+        wakeupMainLoop();
 }
 
 void Terminal::setCursorDisplay(CursorDisplay _display)
@@ -705,6 +1049,24 @@ void Terminal::setWordDelimiters(string const& _wordDelimiters)
     wordDelimiters_ = unicode::from_utf8(_wordDelimiters);
 }
 
+void Terminal::setHistoryDiskQuota(optional<size_t> _quota)
+{
+    if (_quota == screen_.historyDiskQuota())
+        return;
+
+    auto const droppedLineCount = screen_.primaryGrid().spilledLineCount();
+    screen_.setHistoryDiskQuota(_quota);
+
+    if (droppedLineCount == 0 || !screen_.isPrimaryScreen())
+        return;
+
+    if (auto const offset = viewport_.absoluteScrollOffset(); offset.has_value())
+        viewport_.scrollToAbsolute(std::max(*offset - droppedLineCount, 0));
+
+    if (selector_)
+        clearSelection();
+}
+
 string Terminal::extractSelectionText() const
 {
     using namespace terminal;
@@ -712,8 +1074,9 @@ string Terminal::extractSelectionText() const
     string text;
     string currentLine;
 
+    // Held across the whole selection, as the grid decodes history lines while it is being walked.
+    auto const _lock = scoped_lock{ *this };
     renderSelection([&](Coordinate const& _pos, Cell const& _cell) {
-        auto const _lock = scoped_lock{ *this };
         auto const isNewLine = _pos.column <= lastColumn;
         auto const isLineWrapped = lineWrapped(_pos.row);
         bool const touchesRightPage = _pos.row > 0
@@ -726,7 +1089,7 @@ string Terminal::extractSelectionText() const
             text += '\n';
             currentLine.clear();
         }
-        currentLine += _cell.toUtf8();
+        currentLine += _cell.toUtf8(screen_.grid().clusters());
         lastColumn = _pos.column;
     });
 
@@ -761,7 +1124,7 @@ string Terminal::extractLastMarkRange() const
     for (auto lineNum = firstLine; lineNum <= lastLine; ++lineNum)
     {
         for (auto colNum = 1; colNum < colCount; ++colNum)
-            text += screen_.at({lineNum, colNum}).toUtf8();
+            text += screen_.at({lineNum, colNum}).toUtf8(screen_.grid().clusters());
         trimSpaceRight(text);
         text += '\n';
     }
@@ -797,6 +1160,13 @@ void Terminal::scrollbackBufferCleared()
 void Terminal::screenUpdated()
 {
     screenDirty_ = true;
+
+    if (this_thread::get_id() == mainLoopThreadID_ && deferScreenUpdates_)
+    {
+        screenUpdateDeferred_ = true;
+        return;
+    }
+
     //pty_.wakeupReader();
     eventListener_.screenUpdated();
 }
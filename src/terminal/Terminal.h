@@ -21,10 +21,13 @@
 #include <terminal/Viewport.h>
 #include <terminal/RenderBuffer.h>
 
+#include <crispy/spsc_ring.h>
+
 #include <fmt/format.h>
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -34,6 +37,8 @@
 
 namespace terminal {
 
+class TerminalScheduler;
+
 /// Terminal API to manage input and output devices of a pseudo terminal, such as keyboard, mouse, and screen.
 ///
 /// With a terminal being attached to a Process, the terminal's screen
@@ -81,8 +86,22 @@ class Terminal : public ScreenEvents {
 
     void start();
 
+    /// Processes the PTY's input as tasks on the threads of @p _scheduler, which must outlive
+    /// this terminal, instead of on a thread of its own.
+    ///
+    /// Falls back to start() if the PTY cannot be scheduled, or if a PTY reader ring is configured.
+    void start(TerminalScheduler& _scheduler);
+
     void setRefreshRate(double _refreshRate);
 
+    /// Lets a dedicated thread drain the PTY into a ring buffer of (at least) @p _capacity bytes,
+    /// which the main loop then parses from in slices of up to the PTY read buffer size.
+    /// That way the application keeps writing while its previous output is being parsed.
+    ///
+    /// With a capacity of 0 (default), the main loop reads the PTY by itself.
+    /// This must be configured before start().
+    void setPtyReaderRingCapacity(size_t _capacity);
+
     /// Retrieves the time point this terminal instance has been spawned.
     std::chrono::steady_clock::time_point startTime() const noexcept { return startTime_; }
 
@@ -160,17 +179,13 @@ class Terminal : public ScreenEvents {
     void breakLoopAndRefreshRenderBuffer();
 
     /// Refreshes the render buffer.
-    /// When this function returns, the back buffer is updated
-    /// and it is attempted to swap the back/front buffers.
-    /// but the swap has NOT been invoked yet.
+    /// When this function returns, the refreshed render buffer has been published
+    /// and is acquired by the next call to renderBuffer().
     ///
-    /// @retval true   front buffer now contains the refreshed render buffer.
-    /// @retval false  back buffer contains the refreshed render buffer,
-    ///                and RenderDoubleBuffer::swapBuffers() must again
-    ///                be successfully invoked to swap back/front buffers
-    ///                in order to access the refreshed render buffer.
+    /// @returns whether the render buffer is waiting for the next refresh again,
+    ///          which is always the case as publishing never fails.
     ///
-    /// @see RenderDoubleBuffer::swapBuffers()
+    /// @see RenderTripleBuffer::swapBuffers()
     /// @see renderBuffer()
     ///
     bool refreshRenderBuffer(std::chrono::steady_clock::time_point _now);
@@ -180,14 +195,14 @@ class Terminal : public ScreenEvents {
     /// - viewport has changed, or
     /// - refreshing the render buffer was explicitly requested.
     ///
-    /// @see RenderDoubleBuffer::swapBuffers()
+    /// @see RenderTripleBuffer::swapBuffers()
     /// @see renderBuffer()
     void ensureFreshRenderBuffer(std::chrono::steady_clock::time_point _now);
 
-    /// Aquuires read-access handle to front render buffer.
+    /// Aquires read-access handle to the most recently published render buffer.
     ///
-    /// This also acquires the reader lock and releases it automatically
-    /// upon RenderBufferRef destruction.
+    /// The handle stays valid until the next call to this function,
+    /// which must only be invoked by a single (render) thread.
     ///
     /// @see ensureFreshRenderBuffer()
     /// @see refreshRenderBuffer()
@@ -232,6 +247,13 @@ class Terminal : public ScreenEvents {
     // {{{ selection management
     // TODO: move you, too?
     void setWordDelimiters(std::string const& _wordDelimiters);
+
+    /// Replaces the primary screen's history file by one of the given quota, or drops it.
+    ///
+    /// Lines spilled into the previous history file are gone, hence viewport and selection
+    /// are adjusted accordingly. The terminal must be locked, as the main loop may be spilling
+    /// history lines into the previous history file meanwhile.
+    void setHistoryDiskQuota(std::optional<size_t> _quota);
     std::u32string const& wordDelimiters() const noexcept { return wordDelimiters_; }
 
     Selector const* selector() const noexcept { return selector_.get(); }
@@ -271,11 +293,48 @@ class Terminal : public ScreenEvents {
     bool isMouseHoveringHyperlink() const noexcept { return hoveringHyperlink_.load(); }
 
     bool processInputOnce();
+    bool processInputOnce(std::chrono::milliseconds _timeout);
 
   private:
+    /// Reflows the next chunk of primary screen history lines pending reflow.
+    ///
+    /// @returns whether there are still lines pending reflow.
+    bool reflowPendingLines();
+
+    /// Reflows the primary screen history lines [@p _line, @p _line + @p _count) that are pending reflow,
+    /// adjusting viewport and selection to the line shifts. Only to be invoked while the primary screen is active.
+    void reflowPendingLinesWithin(int _line, int _count);
+
+    /// Wakes up the main loop if it is waiting for PTY input, without touching the render buffer.
+    void wakeupMainLoop();
+
     void flushInput();
     void mainLoop();
+
+    // TerminalScheduler task interface
+    friend class TerminalScheduler;
+
+    /// Processes whatever input is available without waiting.
+    /// @returns false once the PTY has been closed.
+    bool processScheduledInput();
+    /// Notifies the event listener that this terminal's input will no longer be processed.
+    void scheduledInputClosed();
+    bool hasPendingInputProcessing() const noexcept { return reflowPending_; }
+
+    /// Reads the PTY and writes the result to the screen.
+    /// @returns the same as Pty::read().
+    int processPtyInput(std::chrono::milliseconds _timeout);
+
+    /// Same as processPtyInput() but reading from the PTY reader's ring buffer instead.
+    int processPtyReaderInput(std::chrono::milliseconds _timeout);
+
+    /// Grows or shrinks the read buffer between the configured PTY read buffer size
+    /// and MaxReadBufferGrowth times that, depending on how much the last read returned.
+    void adaptReadBufferSize(size_t _lastReadSize);
+    void ptyReaderLoop();
     void refreshRenderBuffer(RenderBuffer& _output);
+    void refreshRenderLine(RenderLine& _output, int _row, int _baseLine, bool _reverseVideo);
+    void updateRenderBufferDamage(HyperlinkInfo const* _hoveredHyperlink);
     std::optional<RenderCursor> renderCursor();
     void updateCursorVisibilityState(std::chrono::steady_clock::time_point _now) const;
     bool updateCursorHoveringState();
@@ -323,17 +382,57 @@ class Terminal : public ScreenEvents {
     /// Boolean, indicating whether the terminal's screen buffer contains updates to be rendered.
     mutable std::atomic<uint64_t> changes_;
 
-    std::thread::id mainLoopThreadID_{};
+    std::atomic<std::thread::id> mainLoopThreadID_{};
     int ptyReadBufferSize_;
     Events& eventListener_;
 
     std::chrono::milliseconds refreshInterval_;
     bool screenDirty_ = false;
-    RenderDoubleBuffer renderBuffer_{};
+    RenderTripleBuffer renderBuffer_{};
+
+    /// What the render buffers' line segments have been built from, besides the grid contents.
+    struct RenderState {
+        crispy::Size pageSize{};
+        std::optional<int> scrollOffset{};
+        int historyLineCount = 0;
+        bool reverseVideo = false;
+        HyperlinkInfo const* hoveredHyperlink = nullptr;
+        ColorPalette colorPalette{};
+        std::optional<Selector::Mode> selectionMode{};
+        Coordinate selectionFrom{};
+        Coordinate selectionTo{};
+    };
+    RenderState renderState_{};
 
     Pty& pty_;
+
+    static constexpr size_t MaxReadBufferGrowth = 16;
     std::vector<char> readBuffer_;
 
+    // Both only accessed by the main loop thread.
+    bool deferScreenUpdates_ = false;
+    bool screenUpdateDeferred_ = false;
+
+    /// State shared between the main loop (consumer) and the PTY reader thread (producer).
+    struct PtyReader {
+        explicit PtyReader(size_t _capacity): ring{_capacity} {}
+
+        crispy::spsc_ring<char> ring;
+        std::thread thread{};
+
+        // Only used for sleeping; data is passed through the ring without locking.
+        std::mutex lock{};
+        std::condition_variable dataAvailable{};  // signaled by the reader thread
+        std::condition_variable spaceAvailable{}; // signaled by the main loop
+        bool wakeupRequested = false;             // guarded by lock
+        bool producerWaiting = false;             // guarded by lock, reader blocked on a full ring
+
+        std::atomic<bool> stopRequested = false;
+        std::atomic<bool> closed = false;         // the reader thread will not write anymore
+        int error = 0;                            // errno once closed
+    };
+    std::unique_ptr<PtyReader> ptyReader_;
+
     CursorDisplay cursorDisplay_;
     CursorShape cursorShape_;
     bool cursorVisibility_ = true;
@@ -360,10 +459,12 @@ class Terminal : public ScreenEvents {
     std::mutex mutable outerLock_;
     std::mutex mutable innerLock_;
     std::unique_ptr<std::thread> screenUpdateThread_;
+    TerminalScheduler* scheduler_ = nullptr;
     Viewport viewport_;
     std::unique_ptr<Selector> selector_;
     std::atomic<bool> hoveringHyperlink_ = false;
     std::atomic<bool> renderBufferUpdateEnabled_ = true;
+    std::atomic<bool> reflowPending_ = false;
 };
 
 }  // namespace terminal
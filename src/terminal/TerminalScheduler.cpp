@@ -0,0 +1,227 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/TerminalScheduler.h>
+#include <terminal/Terminal.h>
+#include <terminal/logging.h>
+
+#include <crispy/debuglog.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+using std::lock_guard;
+using std::unique_lock;
+
+namespace terminal {
+
+TerminalScheduler::TerminalScheduler(size_t _threadCount)
+{
+#if defined(__linux__)
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    stopEventFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    auto event = epoll_event{};
+    event.events = EPOLLIN; // level-triggered, so that it wakes up all threads
+    event.data.u64 = 0;
+    if (epollFd_ < 0 || stopEventFd_ < 0 || epoll_ctl(epollFd_, EPOLL_CTL_ADD, stopEventFd_, &event) < 0)
+    {
+        debuglog(TerminalTag).write("Failed to set up terminal scheduler. {}", strerror(errno));
+        return;
+    }
+
+    for (size_t i = 0; i < std::max(_threadCount, size_t{1}); ++i)
+        threads_.emplace_back(&TerminalScheduler::workerLoop, this);
+#else
+    (void) _threadCount;
+#endif
+}
+
+TerminalScheduler::~TerminalScheduler()
+{
+    {
+        auto const _l = lock_guard{lock_};
+        stopping_ = true;
+    }
+
+#if defined(__linux__)
+    if (stopEventFd_ >= 0)
+    {
+        uint64_t const one = 1;
+        auto const rv = ::write(stopEventFd_, &one, sizeof(one));
+        (void) rv;
+    }
+#endif
+
+    for (auto& thread: threads_)
+        thread.join();
+
+#if defined(__linux__)
+    for (auto const fd: {stopEventFd_, epollFd_})
+        if (fd >= 0)
+            ::close(fd);
+#endif
+}
+
+size_t TerminalScheduler::terminalCount() const
+{
+    auto const _l = lock_guard{lock_};
+    return tasks_.size();
+}
+
+bool TerminalScheduler::add(Terminal& _terminal, int _readinessHandle)
+{
+    if (threads_.empty() || _readinessHandle < 0)
+        return false;
+
+    auto const _l = lock_guard{lock_};
+    auto const id = nextId_++;
+    auto& task = tasks_.emplace(id, Task{_terminal, _readinessHandle}).first->second;
+
+#if defined(__linux__)
+    if (arm(id, task, EPOLL_CTL_ADD))
+        return true;
+#endif
+
+    tasks_.erase(id);
+    return false;
+}
+
+void TerminalScheduler::remove(Terminal& _terminal)
+{
+    auto lock = unique_lock{lock_};
+    auto const i = std::find_if(tasks_.begin(), tasks_.end(),
+                                [&](auto const& _entry) { return &_entry.second.terminal == &_terminal; });
+    if (i == tasks_.end())
+        return;
+
+    auto const id = i->first;
+    auto& task = i->second;
+    taskDone_.wait(lock, [&]() { return !task.running; });
+
+#if defined(__linux__)
+    // Fails harmlessly if the terminal's PTY has been closed already.
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, task.readinessHandle, nullptr);
+#endif
+    readyQueue_.erase(std::remove(readyQueue_.begin(), readyQueue_.end(), id), readyQueue_.end());
+    tasks_.erase(id);
+}
+
+bool TerminalScheduler::arm(uint64_t _id, Task const& _task, int _operation)
+{
+#if defined(__linux__)
+    // One-shot, so that no other thread picks up the same terminal while it is being processed.
+    auto event = epoll_event{};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = _id;
+    if (epoll_ctl(epollFd_, _operation, _task.readinessHandle, &event) == 0)
+        return true;
+
+    debuglog(TerminalTag).write("Failed to watch PTY readiness handle {}. {}",
+                                _task.readinessHandle, strerror(errno));
+#else
+    (void) _id;
+    (void) _task;
+    (void) _operation;
+#endif
+    return false;
+}
+
+void TerminalScheduler::workerLoop()
+{
+#if defined(__linux__)
+    auto constexpr MaxPollCount = 16;
+    auto events = std::array<epoll_event, MaxPollCount>{};
+
+    for (;;)
+    {
+        auto hasReadyTasks = false;
+        {
+            auto const _l = lock_guard{lock_};
+            if (stopping_)
+                return;
+            hasReadyTasks = !readyQueue_.empty();
+        }
+
+        // Terminals with pending work are queued up again and again, so PTY input that arrived
+        // meanwhile is queued behind them rather than waiting for that queue to drain.
+        auto const eventCount = hasReadyTasks ? epoll_wait(epollFd_, events.data(), MaxPollCount, 0)
+                                              : epoll_wait(epollFd_, events.data(), 1, -1);
+
+        auto id = uint64_t{0};
+        Task* task = nullptr;
+        {
+            auto const _l = lock_guard{lock_};
+            for (int i = 0; i < eventCount; ++i)
+                if (events[static_cast<size_t>(i)].data.u64)
+                    readyQueue_.push_back(events[static_cast<size_t>(i)].data.u64);
+
+            if (stopping_ || readyQueue_.empty())
+                continue;
+
+            id = readyQueue_.front();
+            readyQueue_.pop_front();
+
+            if (auto const i = tasks_.find(id); i != tasks_.end() && !i->second.closed)
+            {
+                task = &i->second;
+                task->running = true;
+            }
+        }
+
+        if (task)
+            run(id, *task);
+    }
+#endif
+}
+
+void TerminalScheduler::run(uint64_t _id, Task& _task)
+{
+    auto alive = _task.terminal.processScheduledInput();
+
+    {
+        auto const _l = lock_guard{lock_};
+        if (alive && _task.terminal.hasPendingInputProcessing())
+            readyQueue_.push_back(_id);
+#if defined(__linux__)
+        else if (alive)
+            alive = arm(_id, _task, EPOLL_CTL_MOD);
+#endif
+
+        if (alive)
+            _task.running = false;
+        else
+            _task.closed = true;
+    }
+
+    if (!alive)
+    {
+        // Still marked running, so that remove() waits for the listener to be notified.
+        _task.terminal.scheduledInputClosed();
+
+        auto const _l = lock_guard{lock_};
+        _task.running = false;
+    }
+
+    taskDone_.notify_all();
+}
+
+} // end namespace
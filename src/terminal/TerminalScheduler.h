@@ -0,0 +1,93 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace terminal {
+
+class Terminal;
+
+/// Runs the main loops of many terminals on a small, fixed pool of threads,
+/// instead of each terminal running its main loop on a thread of its own.
+///
+/// The PTYs of all terminals are multiplexed via one epoll instance. Whenever a PTY has input
+/// (or its reader got woken up), one of the threads processes that terminal's input as one task.
+/// A terminal is never processed by more than one thread at a time, so that its input is still
+/// processed strictly in order. Terminals take turns, so that one terminal with lots of pending
+/// work (e.g. reflow) does not hold back the others.
+///
+/// Terminals are added via Terminal::start(TerminalScheduler&) and removed by their destructor,
+/// hence the scheduler must outlive them.
+///
+/// Only supported on Linux, and only for PTYs providing a Pty::readinessHandle().
+/// Terminals that cannot be scheduled fall back to running their main loop on their own thread.
+class TerminalScheduler {
+  public:
+    explicit TerminalScheduler(size_t _threadCount);
+    ~TerminalScheduler();
+
+    TerminalScheduler(TerminalScheduler const&) = delete;
+    TerminalScheduler& operator=(TerminalScheduler const&) = delete;
+
+    size_t threadCount() const noexcept { return threads_.size(); }
+
+    /// Number of terminals currently scheduled, including those whose PTY has been closed already.
+    size_t terminalCount() const;
+
+  private:
+    friend class Terminal;
+
+    /// Starts processing @p _terminal's input whenever @p _readinessHandle polls readable.
+    ///
+    /// @returns false if the terminal could not be scheduled.
+    bool add(Terminal& _terminal, int _readinessHandle);
+
+    /// Stops processing @p _terminal's input, waiting for a task in progress to complete.
+    void remove(Terminal& _terminal);
+
+    struct Task {
+        Terminal& terminal;
+        int readinessHandle;
+        bool running = false;
+        bool closed = false;
+    };
+
+    void workerLoop();
+    void run(uint64_t _id, Task& _task);
+    bool arm(uint64_t _id, Task const& _task, int _operation);
+
+    int epollFd_ = -1;
+    int stopEventFd_ = -1;
+
+    mutable std::mutex lock_;
+    std::condition_variable taskDone_;
+    bool stopping_ = false;
+
+    // Tasks are referred to by ID in epoll events and the ready queue, as a terminal may be removed
+    // while an event for it is on its way to a worker thread.
+    uint64_t nextId_ = 1; // 0 denotes stopEventFd_
+    std::unordered_map<uint64_t, Task> tasks_;
+    std::deque<uint64_t> readyQueue_; // tasks with new input or pending work (e.g. reflow), in turn
+
+    std::vector<std::thread> threads_;
+};
+
+} // end namespace
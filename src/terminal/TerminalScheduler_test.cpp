@@ -0,0 +1,138 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/TerminalScheduler.h>
+#include <terminal/Terminal.h>
+#include <terminal/pty/MockPty.h>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <terminal/pty/UnixPty.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    template <typename PtyType>
+    class Session: public terminal::Terminal::Events {
+      public:
+        Session(): pty{{10, 2}}, terminal{pty, 1024, *this} {}
+
+        void onClosed() override { closed = true; }
+
+        string firstLine() const
+        {
+            auto const _l = lock_guard{terminal};
+            return terminal.screen().renderTextLine(1);
+        }
+
+        PtyType pty;
+        terminal::Terminal terminal;
+        atomic<bool> closed = false;
+    };
+
+    bool waitFor(function<bool()> const& _condition)
+    {
+        auto const deadline = chrono::steady_clock::now() + chrono::seconds(10);
+        while (!_condition() && chrono::steady_clock::now() < deadline)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        return _condition();
+    }
+}
+
+#if defined(__linux__)
+TEST_CASE("TerminalScheduler.multiplexes_terminals")
+{
+    auto scheduler = terminal::TerminalScheduler(1);
+    auto a = make_unique<Session<terminal::UnixPty>>();
+    auto b = make_unique<Session<terminal::UnixPty>>();
+
+    a->terminal.start(scheduler);
+    b->terminal.start(scheduler);
+    CHECK(scheduler.terminalCount() == 2);
+
+    // The line discipline echoes back whatever is written to the master.
+    a->pty.write("foo", 3);
+    b->pty.write("bar", 3);
+    CHECK(waitFor([&]() { return a->firstLine() == "foo       "; }));
+    CHECK(waitFor([&]() { return b->firstLine() == "bar       "; }));
+
+    a->pty.close();
+    CHECK(waitFor([&]() { return a->closed.load(); }));
+    CHECK_FALSE(b->closed);
+
+    b->pty.write("baz", 3);
+    CHECK(waitFor([&]() { return b->firstLine() == "barbaz    "; }));
+
+    a.reset();
+    CHECK(scheduler.terminalCount() == 1);
+    b.reset();
+    CHECK(scheduler.terminalCount() == 0);
+}
+
+TEST_CASE("TerminalScheduler.takes_turns")
+{
+    auto scheduler = terminal::TerminalScheduler(1);
+    auto a = make_unique<Session<terminal::UnixPty>>();
+    auto b = make_unique<Session<terminal::UnixPty>>();
+
+    auto const pendingReflowLineCount = [&]() {
+        auto const _l = lock_guard{a->terminal};
+        return a->terminal.screen().primaryGrid().pendingReflowLineCount();
+    };
+
+    // Enough history for the reflow to take many turns of the only thread.
+    auto history = string{};
+    for (int i = 0; i < 200000; ++i)
+        history += "0123456789\r\n";
+    a->terminal.screen().write(history);
+
+    a->terminal.start(scheduler);
+    b->terminal.start(scheduler);
+
+    a->terminal.resizeScreen({5, 2}, nullopt);
+    auto const initialPendingCount = pendingReflowLineCount();
+    REQUIRE(initialPendingCount > 0);
+    REQUIRE(waitFor([&]() { return pendingReflowLineCount() < initialPendingCount; }));
+
+    // The other terminal's input is processed in between, rather than after all of the reflow.
+    b->pty.write("bar", 3);
+    CHECK(waitFor([&]() { return b->firstLine() == "bar       "; }));
+    CHECK(pendingReflowLineCount() > 0);
+
+    CHECK(waitFor([&]() { return pendingReflowLineCount() == 0; }));
+}
+#endif
+
+TEST_CASE("TerminalScheduler.fallback")
+{
+    // Terminals reading their PTY via a reader thread run their main loop on a thread of their own.
+    auto scheduler = terminal::TerminalScheduler(1);
+    auto session = Session<terminal::MockPty>();
+    session.terminal.setPtyReaderRingCapacity(64);
+    session.pty.stdoutBuffer() = "foo";
+    session.terminal.start(scheduler);
+
+    CHECK(scheduler.terminalCount() == 0);
+    CHECK(waitFor([&]() { return session.firstLine() == "foo       "; }));
+}
@@ -19,8 +19,10 @@
 #include <unicode/convert.h>
 
 #include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <iostream>
@@ -39,16 +41,20 @@ namespace // {{{ helpers
 
         terminal::Coordinate lastPos = {};
         size_t lastCount = 0;
-        for (terminal::RenderCell const& cell: renderBuffer.buffer.screen)
+        for (terminal::RenderLine const& line: renderBuffer.buffer.lines)
         {
-            auto const gap = (cell.position.column + static_cast<int>(lastCount) - 1) - lastPos.column;
-            auto& currentLine = lines.at(cell.position.row - 1);
-            if (gap > 0) // Did we jump?
-                currentLine.insert(currentLine.end(), gap - 1, ' ');
-
-            currentLine += unicode::convert_to<char>(u32string_view(cell.codepoints));
-            lastPos = cell.position;
-            lastCount = 1;
+            for (terminal::RenderCell const& cell: line.cells)
+            {
+                auto const gap = (cell.position.column + static_cast<int>(lastCount) - 1) - lastPos.column;
+                auto& currentLine = lines.at(cell.position.row - 1);
+                if (gap > 0) // Did we jump?
+                    currentLine.insert(currentLine.end(), gap - 1, ' ');
+
+                auto const codepoints = line.codepointsOf(cell);
+                currentLine += unicode::convert_to<char>(u32string_view(codepoints.begin(), codepoints.size()));
+                lastPos = cell.position;
+                lastCount = 1;
+            }
         }
 
         return lines;
@@ -157,3 +163,125 @@ TEST_CASE("Terminal.SynchronizedOutput", "[terminal]")
     mc.terminal().ensureFreshRenderBuffer(now);
     CHECK("Hello  World" == trimmedTextScreenshot(mc));
 }
+
+TEST_CASE("Terminal.RenderBuffer.incremental", "[terminal]")
+{
+    auto const now = chrono::steady_clock::now();
+    auto mc = MockTerm{{5, 3}};
+
+    mc.writeToStdout("ABC\r\nDEF\r\nGHI");
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("ABC\nDEF\nGHI\n" == join(textScreenshot(mc.terminal())));
+
+    // Each refresh swaps buffers, so the damage must also reach the buffer not refreshed yet.
+    mc.writeToStdout("\033[2;2HX");
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("ABC\nDXF\nGHI\n" == join(textScreenshot(mc.terminal())));
+
+    mc.writeToStdout("\033[3;1HY");
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("ABC\nDXF\nYHI\n" == join(textScreenshot(mc.terminal())));
+
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("ABC\nDXF\nYHI\n" == join(textScreenshot(mc.terminal())));
+
+    mc.writeToStdout("\033[2J");
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("\n\n\n" == join(textScreenshot(mc.terminal())));
+}
+
+TEST_CASE("Terminal.RenderBuffer.latest_wins", "[terminal]")
+{
+    auto const now = chrono::steady_clock::now();
+    auto mc = MockTerm{{5, 2}};
+
+    // Frames published while the reader holds on to an older frame are never blocked,
+    // and the reader always acquires the most recent one.
+    mc.writeToStdout("A");
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("A" == trimmedTextScreenshot(mc));
+
+    mc.writeToStdout("B");
+    mc.terminal().refreshRenderBuffer(now);
+    mc.writeToStdout("C");
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("ABC" == trimmedTextScreenshot(mc));
+
+    mc.writeToStdout("D");
+    mc.terminal().refreshRenderBuffer(now);
+    mc.writeToStdout("E");
+    mc.terminal().refreshRenderBuffer(now);
+    CHECK("ABCDE" == trimmedTextScreenshot(mc));
+}
+
+TEST_CASE("Terminal.PtyReader", "[terminal]")
+{
+    class Events: public terminal::Terminal::Events {
+      public:
+        void onClosed() override { closed = true; }
+        atomic<bool> closed = false;
+    };
+
+    auto events = Events{};
+    auto pty = terminal::MockPty{{10, 3}};
+    auto pageText = [&](terminal::Terminal const& _terminal) {
+        auto const _l = lock_guard{_terminal};
+        return _terminal.screen().renderTextLine(1) + _terminal.screen().renderTextLine(2)
+             + _terminal.screen().renderTextLine(3);
+    };
+
+    {
+        terminal::Terminal terminal(pty, 4, events);
+
+        // More than fits into the ring at once, so that the reader must wait for the main loop.
+        terminal.setPtyReaderRingCapacity(8);
+        pty.stdoutBuffer() = "ABCDEFGHIJ\r\nKLMNOPQRST\r\nUVWXYZ";
+        terminal.start();
+
+        auto const deadline = chrono::steady_clock::now() + chrono::seconds(10);
+        while (pageText(terminal) != "ABCDEFGHIJKLMNOPQRSTUVWXYZ    " && chrono::steady_clock::now() < deadline)
+            this_thread::sleep_for(chrono::milliseconds(1));
+
+        CHECK(pageText(terminal) == "ABCDEFGHIJKLMNOPQRSTUVWXYZ    ");
+        CHECK_FALSE(events.closed);
+    }
+
+    // Destroying the terminal stops the reader, which in turn ends the main loop.
+    CHECK(events.closed);
+}
+
+TEST_CASE("Terminal.processInputOnce.coalesces_reads", "[terminal]")
+{
+    auto mc = MockTerm{{10, 2}};
+
+    // Several times the PTY read buffer size (1024) is parsed within a single iteration.
+    auto const filler = string(5000, 'X');
+    mc.writeToStdout(filler + "\r\nDONE");
+
+    CHECK(mc.pty().stdoutBuffer().empty());
+    CHECK(mc.terminal().screen().renderTextLine(2) == "DONE      ");
+}
+
+TEST_CASE("Terminal.setHistoryDiskQuota", "[terminal]")
+{
+    auto mc = MockTerm{{10, 2}};
+    auto const& grid = mc.terminal().screen().primaryGrid();
+    auto const textAt = [&](int _absoluteLine) { return grid.renderTextLine(_absoluteLine - grid.historyLineCount() + 1); };
+    mc.terminal().setHistoryDiskQuota(1024 * 1024);
+
+    auto text = string{};
+    for (int i = 0; i < 1100; ++i)
+        text += fmt::format("{}\r\n", i);
+    mc.writeToStdout(text);
+
+    auto const spilledLineCount = grid.spilledLineCount();
+    REQUIRE(spilledLineCount > 0);
+    REQUIRE(mc.terminal().viewport().scrollToAbsolute(spilledLineCount + 10));
+    auto const topLineText = textAt(spilledLineCount + 10);
+
+    // Dropping the history file drops the lines spilled into it, but keeps the viewport on the same lines.
+    mc.terminal().setHistoryDiskQuota(nullopt);
+    CHECK(grid.spilledLineCount() == 0);
+    CHECK(mc.terminal().viewport().absoluteScrollOffset() == 10);
+    CHECK(textAt(10) == topLineText);
+}
@@ -121,6 +121,15 @@ class Viewport {
         return false;
     }
 
+    /// Keeps the viewport at the lines it is showing, whose absolute line numbers have shifted.
+    bool applyLineShift(LineShift const& _shift)
+    {
+        if (!scrollOffset_.has_value() || scrollOffset_.value() < _shift.line || _shift.delta == 0)
+            return false;
+
+        return scrollToAbsolute(scrollOffset_.value() + _shift.delta);
+    }
+
     bool scrollMarkUp()
     {
         if (scrollingDisabled())
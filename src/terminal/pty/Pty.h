@@ -56,6 +56,10 @@ class Pty {
     /// @notice This is typically implemented using non-blocking I/O.
     virtual void wakeupReader() = 0;
 
+    /// @returns a file descriptor that polls readable whenever read() would return without waiting,
+    ///          including a pending wakeupReader(), or -1 if not supported by this PTY.
+    virtual int readinessHandle() const noexcept { return -1; }
+
     /// Writes to the PTY device, so the other end can read from it.
     ///
     /// @param buf    Buffer of data to be written.
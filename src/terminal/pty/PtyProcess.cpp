@@ -73,6 +73,11 @@ void PtyProcess::wakeupReader()
     return pty_->wakeupReader();
 }
 
+int PtyProcess::readinessHandle() const noexcept
+{
+    return pty_->readinessHandle();
+}
+
 int PtyProcess::write(char const* _buf, size_t _size)
 {
     return pty_->write(_buf, _size);
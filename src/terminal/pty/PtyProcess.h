@@ -38,6 +38,7 @@ class PtyProcess: public Pty
     void prepareChildProcess() override;
     int read(char* buf, size_t size, std::chrono::milliseconds _timeout) override;
     void wakeupReader() override;
+    int readinessHandle() const noexcept override;
     int write(char const* buf, size_t size) override;
     crispy::Size screenSize() const noexcept override;
     void resizeScreen(crispy::Size _cells, std::optional<crispy::Size> _pixels) override;
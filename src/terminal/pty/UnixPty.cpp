@@ -39,6 +39,10 @@
 #include <sys/select.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
+
 using crispy::Size;
 using std::runtime_error;
 using std::numeric_limits;
@@ -115,15 +119,33 @@ UnixPty::UnixPty(Size const& _windowSize, optional<Size> _pixels) :
             break;
     }
 #endif
-    debuglog(PtyTag).write("PTY opened. master={}, slave={}, pipe=({}, {})",
-                            master_, slave_, pipe_.at(0), pipe_.at(1));
+
+#if defined(__linux__)
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    for (auto const fd: {master_, pipe_[0]})
+    {
+        auto event = epoll_event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epollFd_ >= 0 && epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            ::close(epollFd_);
+            epollFd_ = -1;
+        }
+    }
+    if (epollFd_ < 0)
+        debuglog(PtyTag).write("Failed to set up epoll, falling back to select(). {}", strerror(errno));
+#endif
+
+    debuglog(PtyTag).write("PTY opened. master={}, slave={}, pipe=({}, {}), epoll={}",
+                            master_, slave_, pipe_.at(0), pipe_.at(1), epollFd_);
 }
 
 UnixPty::~UnixPty()
 {
     debuglog(PtyTag).write("Destructing.");
 
-    for (auto* fd: {&pipe_.at(0), &pipe_.at(1), &master_, &slave_})
+    for (auto* fd: {&epollFd_, &pipe_.at(0), &pipe_.at(1), &master_, &slave_})
     {
         if (*fd < 0)
             continue;
@@ -167,6 +189,14 @@ int UnixPty::read(char* _buf, size_t _size, std::chrono::milliseconds _timeout)
         return -1;
     }
 
+    if (epollFd_ >= 0)
+        return readEpoll(_buf, _size, _timeout);
+    else
+        return readSelect(_buf, _size, _timeout);
+}
+
+int UnixPty::readSelect(char* _buf, size_t _size, std::chrono::milliseconds _timeout)
+{
     timeval tv{};
     tv.tv_sec = _timeout.count() / 1000;
     tv.tv_usec = (_timeout.count() % 1000) * 1000;
@@ -202,14 +232,7 @@ int UnixPty::read(char* _buf, size_t _size, std::chrono::milliseconds _timeout)
         if (FD_ISSET(pipe_[0], &rfd))
         {
             piped = true;
-            int n = 0;
-            for (bool done = false; !done; )
-            {
-                char dummy[256];
-                rv = ::read(pipe_[0], dummy, sizeof(dummy));
-                done = rv > 0;
-                n += max(rv, 0);
-            }
+            drainWakeupPipe();
         }
 
         if (FD_ISSET(master_, &rfd))
@@ -227,6 +250,53 @@ int UnixPty::read(char* _buf, size_t _size, std::chrono::milliseconds _timeout)
     }
 }
 
+int UnixPty::readEpoll(char* _buf, size_t _size, std::chrono::milliseconds _timeout)
+{
+#if defined(__linux__)
+    epoll_event events[2];
+    auto const rv = epoll_wait(epollFd_, events, 2, static_cast<int>(_timeout.count()));
+
+    if (rv == 0)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    if (rv < 0)
+        return -1;
+
+    bool piped = false;
+    bool readable = false;
+    for (int i = 0; i < rv; ++i)
+    {
+        if (events[i].data.fd == pipe_[0])
+            piped = true;
+        else
+            readable = true; // also set on EPOLLHUP/EPOLLERR, for read() to report
+    }
+
+    if (piped)
+        drainWakeupPipe();
+
+    if (readable)
+        return static_cast<int>(::read(master_, _buf, _size));
+
+    errno = EINTR;
+    return -1;
+#else
+    return readSelect(_buf, _size, _timeout);
+#endif
+}
+
+void UnixPty::drainWakeupPipe()
+{
+    for (bool done = false; !done; )
+    {
+        char dummy[256];
+        done = ::read(pipe_[0], dummy, sizeof(dummy)) > 0;
+    }
+}
+
 int UnixPty::write(char const* buf, size_t size)
 {
     ssize_t rv = ::write(master_, buf, size);
@@ -34,6 +34,7 @@ class UnixPty : public Pty
 
     int read(char* buf, size_t size, std::chrono::milliseconds _timeout) override;
     void wakeupReader() override;
+    int readinessHandle() const noexcept override { return epollFd_; }
     int write(char const* buf, size_t size) override;
     crispy::Size screenSize() const noexcept override;
     void resizeScreen(crispy::Size _cells, std::optional<crispy::Size> _pixels = std::nullopt) override;
@@ -42,11 +43,24 @@ class UnixPty : public Pty
     void prepareChildProcess() override;
     void close() override;
 
+    /// Mechanism read() uses to wait for the PTY master and wakeupReader().
+    enum class ReadBackend {
+        Select,
+        Epoll,  // Linux only; falls back to Select if the epoll instance cannot be set up.
+    };
+
+    ReadBackend readBackend() const noexcept { return epollFd_ >= 0 ? ReadBackend::Epoll : ReadBackend::Select; }
+
   private:
+    int readSelect(char* buf, size_t size, std::chrono::milliseconds _timeout);
+    int readEpoll(char* buf, size_t size, std::chrono::milliseconds _timeout);
+    void drainWakeupPipe();
+
     crispy::Size size_;
     int master_;
     int slave_;
     std::array<int, 2> pipe_;
+    int epollFd_ = -1; // watching master_ and pipe_[0] once, instead of per read() call.
 };
 
 }  // namespace terminal
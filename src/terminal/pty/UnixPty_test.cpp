@@ -0,0 +1,55 @@
+/**
+ * This file is part of the "libterminal" project
+ *   Copyright (c) 2019-2020 Christian Parpart <christian@parpart.family>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <terminal/pty/UnixPty.h>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <string_view>
+
+using namespace std;
+using namespace std::string_view_literals;
+
+TEST_CASE("UnixPty.read")
+{
+    auto pty = terminal::UnixPty{{80, 25}};
+    auto buffer = array<char, 64>{};
+
+#if defined(__linux__)
+    CHECK(pty.readBackend() == terminal::UnixPty::ReadBackend::Epoll);
+#endif
+
+    // Nothing to read.
+    CHECK(pty.read(buffer.data(), buffer.size(), chrono::milliseconds(0)) == -1);
+    CHECK(errno == EAGAIN);
+
+    // Woken up without anything to read, and only once.
+    pty.wakeupReader();
+    CHECK(pty.read(buffer.data(), buffer.size(), chrono::seconds(4)) == -1);
+    CHECK(errno == EINTR);
+    CHECK(pty.read(buffer.data(), buffer.size(), chrono::milliseconds(0)) == -1);
+    CHECK(errno == EAGAIN);
+
+    // Whatever is written to the master is echoed back by the line discipline.
+    REQUIRE(pty.write("abc", 3) == 3);
+    auto const n = pty.read(buffer.data(), buffer.size(), chrono::seconds(4));
+    REQUIRE(n > 0);
+    CHECK(string_view(buffer.data(), static_cast<size_t>(n)) == "abc"sv);
+
+    pty.close();
+    CHECK(pty.read(buffer.data(), buffer.size(), chrono::milliseconds(0)) == -1);
+    CHECK(errno == ENODEV);
+}
@@ -46,9 +46,9 @@ void ImageRenderer::setCellSize(Size const& _cellSize)
     // TODO: recompute slices here?
 }
 
-void ImageRenderer::renderImage(crispy::Point _pos, ImageFragment const& _fragment)
+void ImageRenderer::renderImage(crispy::Point _pos, RasterizedImage const& _image, Coordinate _offset)
 {
-    if (optional<DataRef> const dataRef = getTextureInfo(_fragment); dataRef.has_value())
+    if (optional<DataRef> const dataRef = getTextureInfo(_image, _offset); dataRef.has_value())
     {
         //std::cout << fmt::format("ImageRenderer.renderImage: {}\n", _fragment);
 
@@ -63,12 +63,12 @@ void ImageRenderer::renderImage(crispy::Point _pos, ImageFragment const& _fragme
     }
 }
 
-optional<ImageRenderer::DataRef> ImageRenderer::getTextureInfo(ImageFragment const& _fragment)
+optional<ImageRenderer::DataRef> ImageRenderer::getTextureInfo(RasterizedImage const& _image, Coordinate _offset)
 {
     auto const key = ImageFragmentKey{
-        _fragment.rasterizedImage().image().id(),
-        _fragment.offset(),
-        _fragment.rasterizedImage().cellSize()
+        _image.image().id(),
+        _offset,
+        _image.cellSize()
     };
 
     if (optional<DataRef> const info = atlas_->get(key); info.has_value())
@@ -81,15 +81,15 @@ optional<ImageRenderer::DataRef> ImageRenderer::getTextureInfo(ImageFragment con
     // FIXME: remember if insertion failed already, don't repeat then? or how to deal with GPU atlas/GPU exhaustion?
 
     auto handle = atlas_->insert(key,
-                                 _fragment.rasterizedImage().cellSize(),
+                                 _image.cellSize(),
                                  cellSize_,
-                                 _fragment.data(),
+                                 _image.fragment(_offset),
                                  colored,
                                  metadata);
 
     // remember image fragment key so we can later on release the GPU memory when not needed anymore.
     if (handle)
-        imageFragmentsInUse_[_fragment.rasterizedImage().image().id()].emplace_back(key);
+        imageFragmentsInUse_[_image.image().id()].emplace_back(key);
 
     return handle;
 }
@@ -87,7 +87,8 @@ class ImageRenderer : public Renderable
     /// Reconfigures the slicing properties of existing images.
     void setCellSize(crispy::Size const& _cellSize);
 
-    void renderImage(crispy::Point _pos, ImageFragment const& _fragment);
+    /// Renders the fragment at the 0-based grid offset @p _offset of @p _image.
+    void renderImage(crispy::Point _pos, RasterizedImage const& _image, Coordinate _offset);
 
     /// notify underlying cache that this fragment is not going to be rendered anymore, maybe freeing up some GPU caches.
     void discardImage(Image::Id _imageId);
@@ -97,7 +98,7 @@ class ImageRenderer : public Renderable
     using DataRef = TextureAtlas::DataRef;
 
   private:
-    std::optional<DataRef> getTextureInfo(ImageFragment const& _fragment);
+    std::optional<DataRef> getTextureInfo(RasterizedImage const& _image, Coordinate _offset);
 
     // private data
     //
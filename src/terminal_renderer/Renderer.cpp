@@ -210,7 +210,8 @@ uint64_t Renderer::render(Terminal& _terminal,
         executeImageDiscards();
         textRenderer_.start();
         textRenderer_.setPressure(pressure);
-        renderCells(renderBuffer.get().screen);
+        for (RenderLine const& line: renderBuffer.get().lines)
+            renderCells(line);
         textRenderer_.finish();
 
         if (cursorOpt)
@@ -226,9 +227,9 @@ uint64_t Renderer::render(Terminal& _terminal,
     return changes;
 }
 
-tuple<RGBColor, RGBColor> makeColors(ColorPalette const& _colorPalette, Cell const& _cell, bool _reverseVideo, bool _selected)
+tuple<RGBColor, RGBColor> makeColors(ColorPalette const& _colorPalette, GraphicsAttributes const& _attributes, bool _reverseVideo, bool _selected)
 {
-    auto const [fg, bg] = _cell.attributes().makeColors(_colorPalette, _reverseVideo);
+    auto const [fg, bg] = _attributes.makeColors(_colorPalette, _reverseVideo);
     if (!_selected)
         return tuple{fg, bg};
 
@@ -254,15 +255,15 @@ constexpr CellFlags toCellStyle(Decorator _decorator)
     return CellFlags{};
 }
 
-void Renderer::renderCells(vector<RenderCell> const& _renderableCells)
+void Renderer::renderCells(RenderLine const& _renderableCells)
 {
-    for (RenderCell const& cell: _renderableCells)
+    for (RenderCell const& cell: _renderableCells.cells)
     {
         backgroundRenderer_.renderCell(cell);
         decorationRenderer_.renderCell(cell);
-        textRenderer_.renderCell(cell);
-        if (cell.image.has_value())
-            imageRenderer_.renderImage(gridMetrics_.map(cell.position), *cell.image);
+        textRenderer_.renderCell(cell, _renderableCells.codepointsOf(cell));
+        if (RasterizedImage const* image = _renderableCells.imageOf(cell); image != nullptr)
+            imageRenderer_.renderImage(gridMetrics_.map(cell.position), *image, cell.imageOffset);
     }
 }
 
@@ -276,7 +277,7 @@ optional<RenderCursor> Renderer::renderCursor(Terminal const& _terminal)
 
     // TODO: check if CursorStyle has changed, and update render context accordingly.
 
-    Cell const& cursorCell = _terminal.screen().at(_terminal.screen().cursor().position);
+    Cell const cursorCell = _terminal.screen().at(_terminal.screen().cursor().position);
 
     auto const cursorShape = _terminal.screen().focused() ? _terminal.cursorShape()
                                                           : CursorShape::Rectangle;
@@ -130,7 +130,7 @@ class Renderer : public Renderable {
     }
 
   private:
-    void renderCells(std::vector<RenderCell> const& _renderableCells);
+    void renderCells(RenderLine const& _renderableCells);
 
     std::optional<RenderCursor> renderCursor(Terminal const& _terminal);
 
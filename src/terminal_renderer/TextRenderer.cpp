@@ -129,7 +129,7 @@ void TextRenderer::updateFontMetrics()
     clearCache();
 }
 
-void TextRenderer::renderCell(RenderCell const& _cell)
+void TextRenderer::renderCell(RenderCell const& _cell, crispy::span<char32_t const> _codepoints)
 {
     auto const style = [](auto mask) constexpr -> TextStyle {
         if (contains_all(mask, CellFlags::Bold | CellFlags::Italic))
@@ -141,12 +141,10 @@ void TextRenderer::renderCell(RenderCell const& _cell)
         return TextStyle::Regular;
     }(_cell.flags);
 
-    auto const codepoints = crispy::span(_cell.codepoints.data(), _cell.codepoints.size());
-
     if (_cell.flags & CellFlags::CellSequenceStart)
         textRenderingEngine_->setTextPosition(gridMetrics_.map(_cell.position));
 
-    textRenderingEngine_->appendCell(codepoints, style, _cell.foregroundColor);
+    textRenderingEngine_->appendCell(_codepoints, style, _cell.foregroundColor);
 
     if (_cell.flags & CellFlags::CellSequenceEnd)
         textRenderingEngine_->endSequence();
@@ -314,7 +314,7 @@ class TextRenderer : public Renderable {
     void setPressure(bool _pressure) noexcept { pressure_ = _pressure; }
 
     void start();
-    void renderCell(RenderCell const& _cell);
+    void renderCell(RenderCell const& _cell, crispy::span<char32_t const> _codepoints);
     void finish();
 
     void debugCache(std::ostream& _textOutput) const;